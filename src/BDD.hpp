@@ -1,70 +1,168 @@
 #pragma once
 
+#include "mapped_file.hpp"
+#include "node_store.hpp"
 #include "truth_table.hpp"
+#include "work_stealing_pool.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
 #include <iostream>
-#include <vector>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <random>
+#include <stdexcept>
+#include <string>
 #include <unordered_map>
-#include <functional>
+#include <vector>
 
-/* These are just some hacks to hash std::pair (for the unique table).
- * You don't need to understand this part. */
-namespace std
-{
-template<class T>
-inline void hash_combine( size_t& seed, T const& v )
-{
-  seed ^= hash<T>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
-}
+/* The instrumentation of the manager (see `Basic_BDD::Instrumentation`) is compiled in only if
+ * `BDD_INSTRUMENTATION` is defined, e.g., with `-DBDD_INSTRUMENTATION`. Otherwise, its hooks expand
+ * to nothing and cost nothing. All translation units of a program must agree on it. */
+#ifdef BDD_INSTRUMENTATION
+#define BDD_INSTRUMENT( ... ) __VA_ARGS__
+#else
+#define BDD_INSTRUMENT( ... )
+#endif
 
-template<>
-struct hash<pair<uint32_t, uint32_t>>
+/* Thrown by an operation that would exceed the memory budget set by `Basic_BDD::set_memory_limit`,
+ * even after garbage collection and shrinking the computed table. The operation is abandoned, but
+ * the manager stays consistent: the referenced functions and the operands remain valid. */
+struct Memory_Limit_Exceeded : std::runtime_error
 {
-  using argument_type = pair<uint32_t, uint32_t>;
-  using result_type = size_t;
-  result_type operator() ( argument_type const& in ) const
-  {
-    result_type seed = 0;
-    hash_combine( seed, in.first );
-    hash_combine( seed, in.second );
-    return seed;
-  }
+  using std::runtime_error::runtime_error;
 };
-}
 
-class BDD
+/* `Index` is the unsigned integer type of the edges: with `uint32_t` (see `BDD`), a manager holds
+ * up to 2^31 nodes; with `uint64_t` (see `BDD64`), it is only limited by memory. */
+template<typename Index = uint32_t>
+class Basic_BDD
 {
 public:
-  using index_t = uint32_t;
+  using index_t = Index;
   /* Declaring `index_t` as an alias for an unsigned integer.
    * This is just for easier understanding of the code.
-   * This datatype will be used for node indices. */
+   * This datatype will be used for edges (i.e., references to nodes).
+   *
+   * An edge packs the index of the node it points to together with a
+   * complement attribute in its lowest bit: edge = ( node index << 1 ) | complement.
+   * A complemented edge represents the negation of the function of the node. */
 
   using var_t = uint32_t;
   /* Similarly, declare `var_t` also as an alias for an unsigned integer.
    * This datatype will be used for representing variables. */
 
 private:
+  /* The fields compared by a unique table lookup come first, followed by the other fields read
+   * when visiting a node, all packed without padding: 20 bytes with 32-bit indices, and half a
+   * cache line (32 bytes) with 64-bit ones. With 32-bit indices, the 12 bytes read by a lookup
+   * (`T`, `E` and `next`) straddle two cache lines for 2 nodes in 16; padding the nodes to 32 bytes
+   * would avoid it, but take 60% more memory per node, and so fewer nodes in the caches. */
   struct Node
   {
+    index_t T; /* edge to THEN child (never complemented) */
+    index_t E; /* edge to ELSE child */
+    index_t next; /* index of the next node in the same unique table bucket (0 if last) */
     var_t v; /* corresponding variable */
-    index_t T; /* index of THEN child */
-    index_t E; /* index of ELSE child */
+    uint32_t ref; /* reference count: external references plus living parents (saturating, see `add_ref`) */
+  };
+  static_assert( sizeof( Node ) == ( sizeof( index_t ) == 4u ? 20u : 32u ), "Keep the nodes packed." );
+
+  /* The unique table of one variable: a hash table with separate chaining.
+   * The chains are threaded through the `next` field of the nodes, so the
+   * table itself only stores the index of the first node of each bucket. */
+  struct Subtable
+  {
+    std::vector<index_t> buckets; /* power-of-two many chain heads (0 if empty) */
+    uint64_t num_entries; /* number of nodes stored */
+  };
+
+  /* Operation codes used to key the computed table. */
+  enum Op : uint32_t
+  {
+    OP_NONE = 0, /* marks an empty entry */
+    OP_AND,
+    OP_OR,
+    OP_XOR,
+    OP_ITE,
+    OP_AND_EXISTS,
+    OP_COMPOSE,
+    OP_VECTOR_COMPOSE,
+    OP_CONSTRAIN,
+    OP_RESTRICT,
+    OP_ZDD_UNION,
+    OP_ZDD_INTERSECTION,
+    OP_ZDD_DIFFERENCE,
+    OP_ZDD_CHANGE,
+    OP_ZDD_SUBSET0,
+    OP_ZDD_SUBSET1,
+    OP_ZDD_PRODUCT,
+    OP_ZDD_DIVIDE,
+    OP_ZDD_FROM_BDD,
+    OP_ZDD_TO_BDD,
+    OP_ADD_PLUS,
+    OP_ADD_TIMES,
+    OP_ADD_MIN,
+    OP_ADD_MAX,
+    OP_ADD_THRESHOLD,
+    OP_ADD_SUM_ABSTRACT,
+    OP_ADD_MAX_ABSTRACT,
+    OP_ADD_FROM_BDD,
+    OP_ADD_TO_BDD,
+    OP_ISOP,
+    NUM_OPS
+  };
+
+  struct Cache_Entry
+  {
+    uint32_t op; /* operation code */
+    index_t f, g, h; /* operands (unused ones are 0) */
+    index_t r; /* result */
+    uint32_t seq; /* odd while being written by a thread of the parallel apply (see `cache_insert_concurrent`) */
   };
 
 public:
-  explicit BDD( uint32_t num_vars )
-    : unique_table( num_vars ), num_invoke_not( 0u ), num_invoke_and( 0u ), num_invoke_or( 0u ), 
-      num_invoke_xor( 0u ), num_invoke_ite( 0u )
-  {
-    nodes.emplace_back( Node({num_vars, 0, 0}) ); /* constant 0 */
-    nodes.emplace_back( Node({num_vars, 1, 1}) ); /* constant 1 */
-    /* `nodes` is initialized with two `Node`s representing the terminal (constant) nodes.
-     * Their `v` is `num_vars` and their indices are 0 and 1.
+  explicit Basic_BDD( uint32_t num_vars, uint32_t cache_size = 1u << 16 )
+    : unique_table( num_vars, Subtable( {std::vector<index_t>( initial_buckets() ), 0u} ) ),
+      zdd_table( num_vars, Subtable( {std::vector<index_t>( initial_buckets() ), 0u} ) ),
+      add_table( num_vars, Subtable( {std::vector<index_t>( initial_buckets() ), 0u} ) ), num_invoke_not( 0u ), num_invoke_and( 0u ), num_invoke_or( 0u ),
+      num_invoke_xor( 0u ), num_invoke_ite( 0u ), num_invoke_and_exists( 0u ), num_invoke_compose( 0u ), num_invoke_constrain( 0u ),
+      num_invoke_restrict( 0u ), num_invoke_zdd( 0u ), num_invoke_add( 0u ), num_invoke_isop( 0u ),
+      num_cache_hit( 0u ), num_cache_miss( 0u ),
+      num_cache_eviction( 0u ), num_unique_lookup( 0u ), num_unique_probe( 0u ), num_dead( 0u ), gc_dead_ratio( 0.5 ), gc_min_dead( 1u << 16 ), num_gc( 0u ),
+      num_recycled( 0u ), auto_reorder( false ), max_growth( 1.2 ), next_reorder( 1u << 12 ), num_reorder( 0u ),
+      num_swap( 0u ), composition_id( 0u ), num_minimize( 0u ),
+      minimize_nodes_before( 0u ), minimize_nodes_after( 0u ), max_spawn_depth( 0u ), parallel_aborted( false ),
+      max_nodes( std::numeric_limits<uint64_t>::max() ), max_bytes( std::numeric_limits<uint64_t>::max() ), limit_active( false ),
+      byte_limit_hit( false ), num_memory_abort( 0u )
+  {
+    resize_cache( cache_size );
+    BDD_INSTRUMENT( instr = Instrumentation(); instr.start = std::chrono::steady_clock::now(); instr.unique_lookups.resize( num_vars );
+                    instr.unique_probes.resize( num_vars ); instr.unique_collisions.resize( num_vars ); instr.diagram_lookups.resize( num_vars );
+                    instr.diagram_probes.resize( num_vars ); instr.diagram_collisions.resize( num_vars ); set_instrumentation_dump( nullptr, 0.0 ); )
+
+    for ( var_t v = 0u; v <= num_vars; ++v )
+    {
+      var2level.emplace_back( v );
+      level2var.emplace_back( v );
+    }
+
+    nodes.emplace_back( Node( {0, 0, 0, num_vars, 1} ) ); /* constant 1 */
+    /* `nodes` is initialized with a single `Node` representing the terminal (constant) node.
+     * Its `v` is `num_vars` and its index is 0.
      * (Note that the real variables range from 0 to `num_vars - 1`.)
-     * Both of their children point to themselves, just for convenient representation.
+     * Both of its children point to itself, just for convenient representation.
+     * The regular edge to it (0) is constant 1 and the complemented edge (1) is constant 0.
+     * It holds a permanent reference so that it is never dead.
      *
-     * `unique_table` is initialized with `num_vars` empty maps. */
+     * `unique_table` (and `zdd_table` and `add_table`) is initialized with `num_vars` empty hash tables.
+     * The variable order is initialized to x_0 (top), x_1, ..., x_{num_vars - 1} (bottom).
+     * `computed_table` is initialized with `cache_size` (rounded up to a power of two) empty entries. */
   }
 
   /**********************************************************/
@@ -76,10 +174,22 @@ public:
     return unique_table.size();
   }
 
-  /* Get the (index of) constant node. */
-  index_t constant( bool value ) const
+  /* Get the (edge to the) constant node. */
+  static index_t constant( bool value )
+  {
+    return value ? 0 : 1;
+  }
+
+  /* Whether the edge `f` is complemented. */
+  static bool is_complemented( index_t f )
+  {
+    return f & 1;
+  }
+
+  /* The non-complemented version of edge `f`. */
+  static index_t regular( index_t f )
   {
-    return value ? 1 : 0;
+    return f & ~index_t( 1 );
   }
 
   /* Look up (if exist) or build (if not) the node with variable `var`,
@@ -87,10 +197,10 @@ public:
   index_t unique( var_t var, index_t T, index_t E )
   {
     assert( var < num_vars() && "Variables range from 0 to `num_vars - 1`." );
-    assert( T < nodes.size() && "Make sure the children exist." );
-    assert( E < nodes.size() && "Make sure the children exist." );
-    assert( nodes[T].v > var && "With static variable order, children can only be below the node." );
-    assert( nodes[E].v > var && "With static variable order, children can only be below the node." );
+    assert( ( T >> 1 ) < nodes.size() && "Make sure the children exist." );
+    assert( ( E >> 1 ) < nodes.size() && "Make sure the children exist." );
+    assert( level( T ) > var2level[var] && "Children can only be below the node." );
+    assert( level( E ) > var2level[var] && "Children can only be below the node." );
 
     /* Reduction rule: Identical children */
     if ( T == E )
@@ -98,21 +208,14 @@ public:
       return T;
     }
 
-    /* Look up in the unique table. */
-    const auto it = unique_table[var].find( {T, E} );
-    if ( it != unique_table[var].end() )
-    {
-      /* The required node already exists. Return it. */
-      return it->second;
-    }
-    else
+    /* Canonical form: the THEN edge is never complemented.
+     * Use x ? T : E = ~( x ? ~T : ~E ) to move the complement to the returned edge. */
+    if ( is_complemented( T ) )
     {
-      /* Create a new node and insert it to the unique table. */
-      index_t const new_index = nodes.size();
-      nodes.emplace_back( Node({var, T, E}) );
-      unique_table[var][{T, E}] = new_index;
-      return new_index;
+      return unique( var, T ^ 1, E ^ 1 ) ^ 1;
     }
+
+    return find_or_add( unique_table[var], var, T, E );
   }
 
   /* Return a node (represented with its index) of function F = x_var or F = ~x_var. */
@@ -121,432 +224,4429 @@ public:
     return unique( var, constant( !complement ), constant( complement ) );
   }
 
-  /**********************************************************/
-  /********************* BDD Operations *********************/
-  /**********************************************************/
-
-  /* Compute ~f */
-  index_t NOT( index_t f )
+  /* Build the BDD of the function given by `tt` over the variables x_0, ..., x_{tt.num_var - 1}
+   * (at most `num_vars()`), in time linear in the size of the table.
+   *
+   * The table is rearranged with the variables in level order, the bottom one being the least
+   * significant. Each word then holds a sub-function of the bottom 6 variables: the distinct words
+   * are built once each, and the levels above are built pairwise, from the bottom up, on arrays of
+   * edges halving at each level. Identical sub-tables thus always meet in `unique`. */
+  index_t from_tt( Truth_Table const& tt )
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-    ++num_invoke_not;
+    assert( tt.num_var <= num_vars() && "Make sure the variables exist." );
+    before_operation( constant( true ), constant( true ) );
 
-    /* trivial cases */
-    if ( f == constant( false ) )
-    {
-      return constant( true );
-    }
-    if ( f == constant( true ) )
+    uint32_t const k = tt.num_var;
+    std::vector<var_t> order( k ); /* variables of the table from the top level down */
+    for ( var_t v = 0u; v < k; ++v )
     {
-      return constant( false );
+      order[v] = v;
     }
+    std::sort( order.begin(), order.end(), [&]( var_t a, var_t b ) { return var2level[a] < var2level[b]; } );
 
-    Node const& F = nodes[f];
-    var_t x = F.v;
-    index_t f0 = F.E, f1 = F.T;
-
-    index_t const r0 = NOT( f0 );
-    index_t const r1 = NOT( f1 );
-    return unique( x, r1, r0 );
-  }
-
-  /* Compute f ^ g */
-  index_t XOR( index_t f, index_t g )
-  {
-    assert( f < nodes.size() && "Make sure f exists." );
-    assert( g < nodes.size() && "Make sure g exists." );
-    ++num_invoke_xor;
-
-    /* trivial cases */
-    if ( f == g )
-    {
-      return constant( false );
-    }
-    if ( f == constant( false ) )
-    {
-      return g;
-    }
-    if ( g == constant( false ) )
+    std::vector<uint64_t> words( tt.bits );
+    std::vector<var_t> var_at_bit( k ), bit_of_var( k );
+    for ( var_t v = 0u; v < k; ++v )
     {
-      return f;
-    }
-    if ( f == constant( true ) )
-    {
-      return NOT( g );
-    }
-    if ( g == constant( true ) )
-    {
-      return NOT( f );
+      var_at_bit[v] = bit_of_var[v] = v;
     }
-    if ( f == NOT( g ) )
+    for ( auto j = 0u; j < k; ++j )
     {
-      return constant( true );
+      var_t const v = order[k - 1u - j];
+      if ( var_at_bit[j] != v )
+      {
+        uint32_t const q = bit_of_var[v];
+        Truth_Table::swap_vars( words.data(), k, j, q );
+        std::swap( var_at_bit[j], var_at_bit[q] );
+        bit_of_var[var_at_bit[j]] = j;
+        bit_of_var[var_at_bit[q]] = q;
+      }
     }
 
-    Node const& F = nodes[f];
-    Node const& G = nodes[g];
-    var_t x;
-    index_t f0, f1, g0, g1;
-    if ( F.v < G.v ) /* F is on top of G */
+    uint32_t const top = k < 6u ? 0u : k - 6u; /* layer of the top variable of the words */
+    std::unordered_map<uint64_t, index_t> built;
+    std::vector<index_t> layer( words.size() );
+    for ( auto i = 0u; i < words.size(); ++i )
     {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      g0 = g1 = g;
-    }
-    else if ( G.v < F.v ) /* G is on top of F */
-    {
-      x = G.v;
-      f0 = f1 = f;
-      g0 = G.E;
-      g1 = G.T;
+      auto it = built.find( words[i] );
+      if ( it == built.end() )
+      {
+        it = built.emplace( words[i], from_word( words[i], top, order ) ).first;
+      }
+      layer[i] = it->second;
     }
-    else /* F and G are at the same level */
+    for ( auto l = top; l-- > 0u; )
     {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      g0 = G.E;
-      g1 = G.T;
+      for ( auto i = 0u; i < layer.size() / 2u; ++i )
+      {
+        layer[i] = unique( order[l], layer[2u * i + 1u], layer[2u * i] );
+      }
+      layer.resize( layer.size() / 2u );
     }
+    return layer[0];
+  }
+
+  /**********************************************************/
+  /********************* BDD Operations *********************/
+  /**********************************************************/
+
+  /* Compute ~f */
+  index_t NOT( index_t f )
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    ++num_invoke_not;
+
+    /* Toggling the complement attribute is all it takes. */
+    return f ^ 1;
+  }
 
-    index_t const r0 = XOR( f0, g0 );
-    index_t const r1 = XOR( f1, g1 );
-    return unique( x, r1, r0 );
+  /* Compute f ^ g */
+  index_t XOR( index_t f, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_XOR ); )
+    return run_operation( f, g, 0, [&]() { return pool ? parallel_apply<Xor_Op>( f, g, 0 ) : apply<Xor_Op>( f, g, 0 ); } );
   }
 
   /* Compute f & g */
   index_t AND( index_t f, index_t g )
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-    assert( g < nodes.size() && "Make sure g exists." );
-    ++num_invoke_and;
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_AND ); )
+    return run_operation( f, g, 0, [&]() { return pool ? parallel_apply<And_Op>( f, g, 0 ) : apply<And_Op>( f, g, 0 ); } );
+  }
 
-    /* trivial cases */
-    if ( f == constant( false ) || g == constant( false ) )
-    {
-      return constant( false );
-    }
-    if ( f == constant( true ) )
-    {
-      return g;
-    }
-    if ( g == constant( true ) )
-    {
-      return f;
-    }
-    if ( f == g )
-    {
-      return f;
-    }
+  /* Compute f | g */
+  index_t OR( index_t f, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_OR ); )
+    return run_operation( f, g, 0, [&]() { return pool ? parallel_apply<Or_Op>( f, g, 0 ) : apply<Or_Op>( f, g, 0 ); } );
+  }
 
-    Node const& F = nodes[f];
-    Node const& G = nodes[g];
-    var_t x;
-    index_t f0, f1, g0, g1;
-    if ( F.v < G.v ) /* F is on top of G */
-    {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      g0 = g1 = g;
-    }
-    else if ( G.v < F.v ) /* G is on top of F */
-    {
-      x = G.v;
-      f0 = f1 = f;
-      g0 = G.E;
-      g1 = G.T;
-    }
-    else /* F and G are at the same level */
-    {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      g0 = G.E;
-      g1 = G.T;
-    }
+  /* Compute ITE(f, g, h), i.e., f ? g : h */
+  index_t ITE( index_t f, index_t g, index_t h )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ITE ); )
+    return run_operation( f, g, h, [&]() { return pool ? parallel_apply<Ite_Op>( f, g, h ) : apply<Ite_Op>( f, g, h ); } );
+  }
 
-    index_t const r0 = AND( f0, g0 );
-    index_t const r1 = AND( f1, g1 );
-    return unique( x, r1, r0 );
+  /* Compute \exists cube. f, i.e., the disjunction of the cofactors of f over all
+   * assignments of the variables in `cube`. `cube` is the conjunction of their
+   * positive literals, e.g., AND( literal( 1 ), literal( 3 ) ). */
+  index_t exists( index_t f, index_t cube )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_AND_EXISTS ); )
+    return run_operation( f, cube, 0, [&]() { return apply<And_Exists_Op>( f, constant( true ), cube ); } );
   }
 
-  /* Compute f | g */
-  index_t OR( index_t f, index_t g )
+  /* Compute \forall cube. f, i.e., the conjunction of the cofactors of f over all
+   * assignments of the variables in `cube`. */
+  index_t forall( index_t f, index_t cube )
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-    assert( g < nodes.size() && "Make sure g exists." );
-    ++num_invoke_or;
+    return exists( f ^ 1, cube ) ^ 1;
+  }
 
-    /* trivial cases */
-    if ( f == constant( true ) || g == constant( true ) )
-    {
-      return constant( true );
-    }
-    if ( f == constant( false ) )
+  /* Compute \exists cube. ( f & g ) without building f & g (the relational product). */
+  index_t and_exists( index_t f, index_t g, index_t cube )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_AND_EXISTS ); )
+    return run_operation( f, g, cube, [&]() { return apply<And_Exists_Op>( f, g, cube ); } );
+  }
+
+  /**********************************************************/
+  /*************** Composition and Substitution *************/
+  /**********************************************************/
+  /* Compute f|x_var=value, the cofactor of `f` with respect to a literal. */
+  index_t cofactor( index_t f, var_t var, bool value )
+  {
+    return compose( f, var, constant( value ) );
+  }
+
+  /* Compute f|x_var=g, i.e., ITE( g, f|x_var=1, f|x_var=0 ): substitute `g` for variable `var` in `f`. */
+  index_t compose( index_t f, var_t var, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_COMPOSE ); )
+    assert( var < num_vars() && "Make sure the variable exists." );
+    return run_operation( f, g, 0, [&]() {
+      index_t const x = literal( var );
+      return substitute( f, [&]( var_t v ) { return v == var ? g : literal( v ); }, var2level[var], OP_COMPOSE, g, x );
+    } );
+  }
+
+  /* Substitute `substitution[v]` for every variable `v` in `f` simultaneously (which differs from
+   * composing one variable after the other when the substituted functions depend on each other's
+   * variables), in one traversal. `substitution` has `num_vars()` entries; `literal( v )` keeps `v`. */
+  index_t vector_compose( index_t f, std::vector<index_t> const& substitution )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_VECTOR_COMPOSE ); )
+    assert( substitution.size() == num_vars() && "Make sure there is a function for every variable." );
+    /* The substituted functions are operands too: protect them from garbage collection. */
+    for ( auto const g : substitution )
     {
-      return g;
+      ref( g );
     }
-    if ( g == constant( false ) )
+    auto const release = [&]() {
+      for ( auto const g : substitution )
+      {
+        deref( g );
+      }
+    };
+    index_t r;
+    try
     {
-      return f;
+      r = run_operation( f, 0, 0, [&]() { return vector_compose_rec( f, substitution ); } );
     }
-    if ( f == g )
+    catch ( ... )
     {
-      return f;
+      release();
+      throw;
     }
+    release();
+    return r;
+  }
 
-    Node const& F = nodes[f];
-    Node const& G = nodes[g];
-    var_t x;
-    index_t f0, f1, g0, g1;
-    if ( F.v < G.v ) /* F is on top of G */
-    {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      g0 = g1 = g;
-    }
-    else if ( G.v < F.v ) /* G is on top of F */
+  /* Rename the variables of `f`: variable `v` becomes `perm[v]`. `perm` has `num_vars()` entries
+   * and needs not be a permutation (variables may be merged). */
+  index_t permute( index_t f, std::vector<var_t> const& perm )
+  {
+    assert( perm.size() == num_vars() && "Make sure there is a variable for every variable." );
+    std::vector<index_t> substitution;
+    for ( var_t v = 0u; v < num_vars(); ++v )
     {
-      x = G.v;
-      f0 = f1 = f;
-      g0 = G.E;
-      g1 = G.T;
+      substitution.emplace_back( literal( perm[v] ) );
     }
-    else /* F and G are at the same level */
+    return vector_compose( f, substitution );
+  }
+
+  /* Exchange variables `v1` and `v2` in `f`. */
+  index_t swap_vars( index_t f, var_t v1, var_t v2 )
+  {
+    std::vector<var_t> perm;
+    for ( var_t v = 0u; v < num_vars(); ++v )
     {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      g0 = G.E;
-      g1 = G.T;
+      perm.emplace_back( v == v1 ? v2 : v == v2 ? v1 : v );
     }
+    return permute( f, perm );
+  }
+
+  /**********************************************************/
+  /****************** Generalized Cofactors *****************/
+  /**********************************************************/
+  /* The generalized cofactors below simplify `f` with respect to the care set `c`: the result
+   * agrees with `f` wherever `c` holds, and is arbitrary elsewhere. `c` must not be 0. */
 
-    index_t const r0 = OR( f0, g0 );
-    index_t const r1 = OR( f1, g1 );
-    return unique( x, r1, r0 );
+  /* Compute the constrain operator of Coudert and Madre, f|c: the value of `f` at the point of
+   * `c` closest to the argument. Distributes over the Boolean operations, e.g.,
+   * ( f & g )|c = f|c & g|c, but may depend on variables `f` does not. */
+  index_t constrain( index_t f, index_t c )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_CONSTRAIN ); )
+    assert( c != constant( false ) && "Make sure the care set is not empty." );
+    return run_operation( f, c, 0, [&]() { return compute( Generalized_Cofactor_Op( {*this, false} ), f, c, 0 ); } );
   }
 
-  /* Compute ITE(f, g, h), i.e., f ? g : h */
-  index_t ITE( index_t f, index_t g, index_t h )
+  /* Compute the restrict operator of Coudert and Madre: like `constrain`, but the variables of `c`
+   * that `f` does not depend on are quantified out of `c` first, so that the result never depends
+   * on more variables than `f`. Usually gives smaller results. */
+  index_t restrict( index_t f, index_t c )
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-    assert( g < nodes.size() && "Make sure g exists." );
-    assert( h < nodes.size() && "Make sure h exists." );
-    ++num_invoke_ite;
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_RESTRICT ); )
+    assert( c != constant( false ) && "Make sure the care set is not empty." );
+    return run_operation( f, c, 0, [&]() { return compute( Generalized_Cofactor_Op( {*this, true} ), f, c, 0 ); } );
+  }
 
-    /* trivial cases */
-    if ( f == constant( true ) )
-    {
-      return g;
-    }
-    if ( f == constant( false ) )
+  /* Simplify `f` with respect to the care set `c`: the smallest of `restrict( f, c )`,
+   * `constrain( f, c )` and `f` itself, so that the result is never larger than `f`.
+   * The sizes before and after are accumulated in the statistics (see `num_minimized_nodes`). */
+  index_t minimize( index_t f, index_t c )
+  {
+    assert( c != constant( false ) && "Make sure the care set is not empty." );
+    index_t const restricted = run_operation( f, c, 0, [&]() { return compute( Generalized_Cofactor_Op( {*this, true} ), f, c, 0 ); } );
+    index_t const constrained = run_operation( f, c, restricted, [&]() { return compute( Generalized_Cofactor_Op( {*this, false} ), f, c, 0 ); } );
+    index_t const candidates[] = {f, restricted, constrained};
+    index_t r = f;
+    uint64_t size = num_nodes( f );
+    ++num_minimize;
+    minimize_nodes_before += size;
+    for ( auto const g : candidates )
     {
-      return h;
+      uint64_t const g_size = num_nodes( g );
+      if ( g_size < size )
+      {
+        r = g;
+        size = g_size;
+      }
     }
-    if ( g == h )
+    minimize_nodes_after += size;
+    return r;
+  }
+
+  /**********************************************************/
+  /*********** Zero-Suppressed Decision Diagrams ************/
+  /**********************************************************/
+  /* The manager also holds ZDDs, representing families of sets of variables (e.g., a cover, with a
+   * variable per literal). A ZDD node whose THEN child is the empty family is removed, so the
+   * variables absent from the sets cost nothing, which makes families of sparse sets much smaller
+   * than their BDDs. ZDD nodes share the node store, the reference counts and the computed table
+   * with the BDD nodes, and are collected with them, but have their own unique tables and always
+   * follow the order x_0 (top), ..., x_{num_vars - 1}, whatever the order of the BDDs.
+   * ZDD edges are never complemented, and must not be passed to BDD operations (nor vice versa). */
+
+  /* The empty family. */
+  static index_t zdd_empty()
+  {
+    return constant( false );
+  }
+
+  /* The family containing only the empty set. */
+  static index_t zdd_base()
+  {
+    return constant( true );
+  }
+
+  /* Look up (if exist) or build (if not) the ZDD node with variable `var`, THEN child `T` (the
+   * sets containing `var`, without it) and ELSE child `E` (the sets not containing `var`). */
+  index_t zdd_unique( var_t var, index_t T, index_t E )
+  {
+    assert( var < num_vars() && "Variables range from 0 to `num_vars - 1`." );
+    assert( ( T >> 1 ) < nodes.size() && "Make sure the children exist." );
+    assert( ( E >> 1 ) < nodes.size() && "Make sure the children exist." );
+    assert( top_index( T ) > var && top_index( E ) > var && "Children can only be below the node." );
+
+    /* Reduction rule: no set contains `var` */
+    if ( T == zdd_empty() )
     {
-      return g;
+      return E;
     }
+    assert( !is_complemented( T ) && ( !is_complemented( E ) || E == zdd_empty() ) && "ZDD edges are never complemented." );
+    return find_or_add( zdd_table[var], var, T, E );
+  }
 
-    Node const& F = nodes[f];
-    Node const& G = nodes[g];
-    Node const& H = nodes[h];
-    var_t x;
-    index_t f0, f1, g0, g1, h0, h1;
-    if ( F.v <= G.v && F.v <= H.v ) /* F is not lower than both G and H */
+  /* The family { { var } }. */
+  index_t zdd_single( var_t var )
+  {
+    return zdd_unique( var, zdd_base(), zdd_empty() );
+  }
+
+  /* Compute f \cup g */
+  index_t zdd_union( index_t f, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ZDD_UNION ); )
+    return run_operation( f, g, 0, [&]() { return zdd_set_op( OP_ZDD_UNION, f, g ); } );
+  }
+
+  /* Compute f \cap g */
+  index_t zdd_intersection( index_t f, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ZDD_INTERSECTION ); )
+    return run_operation( f, g, 0, [&]() { return zdd_set_op( OP_ZDD_INTERSECTION, f, g ); } );
+  }
+
+  /* Compute f \setminus g */
+  index_t zdd_difference( index_t f, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ZDD_DIFFERENCE ); )
+    return run_operation( f, g, 0, [&]() { return zdd_set_op( OP_ZDD_DIFFERENCE, f, g ); } );
+  }
+
+  /* Toggle `var` in every set of `f`. */
+  index_t zdd_change( index_t f, var_t var )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ZDD_CHANGE ); )
+    assert( var < num_vars() && "Make sure the variable exists." );
+    return run_operation( f, 0, 0, [&]() { return zdd_var_op( OP_ZDD_CHANGE, f, var ); } );
+  }
+
+  /* The sets of `f` not containing `var`. */
+  index_t zdd_subset0( index_t f, var_t var )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ZDD_SUBSET0 ); )
+    assert( var < num_vars() && "Make sure the variable exists." );
+    return run_operation( f, 0, 0, [&]() { return zdd_var_op( OP_ZDD_SUBSET0, f, var ); } );
+  }
+
+  /* The sets of `f` containing `var`, with `var` removed. */
+  index_t zdd_subset1( index_t f, var_t var )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ZDD_SUBSET1 ); )
+    assert( var < num_vars() && "Make sure the variable exists." );
+    return run_operation( f, 0, 0, [&]() { return zdd_var_op( OP_ZDD_SUBSET1, f, var ); } );
+  }
+
+  /* Compute the (unate) product { a \cup b : a \in f, b \in g }, e.g., the conjunction of two covers. */
+  index_t zdd_product( index_t f, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ZDD_PRODUCT ); )
+    return run_operation( f, g, 0, [&]() { return compute( Zdd_Product_Op( {*this} ), f, g, 0 ); } );
+  }
+
+  /* Compute the (weak) quotient of `f` by `g`: the largest family q such that the product of
+   * q and g, made of disjoint unions only, is contained in `f`. `g` must not be empty. */
+  index_t zdd_divide( index_t f, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ZDD_DIVIDE ); )
+    assert( g != zdd_empty() && "Make sure the divisor is not empty." );
+    return run_operation( f, g, 0, [&]() { return compute( Zdd_Divide_Op( {*this} ), f, g, 0 ); } );
+  }
+
+  /* Number of sets in `f`. */
+  long double zdd_count( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    std::unordered_map<index_t, long double> counts( {{zdd_empty(), 0.0l}, {zdd_base(), 1.0l}} );
+    std::vector<index_t> stack( 1u, f );
+    while ( !stack.empty() )
     {
-      x = F.v;
-      f0 = F.E;
-      f1 = F.T;
-      if ( G.v == F.v )
+      index_t const g = stack.back();
+      if ( counts.count( g ) != 0u )
       {
-        g0 = G.E;
-        g1 = G.T;
+        stack.pop_back();
+        continue;
       }
-      else
+      /* Count the sets of `g` once its children are counted. */
+      auto const t = counts.find( get_node( g ).T ), e = counts.find( get_node( g ).E );
+      if ( t != counts.end() && e != counts.end() )
       {
-        g0 = g1 = g;
+        counts.emplace( g, t->second + e->second );
+        stack.pop_back();
+        continue;
       }
-      if ( H.v == F.v )
+      if ( t == counts.end() )
       {
-        h0 = H.E;
-        h1 = H.T;
+        stack.emplace_back( get_node( g ).T );
       }
-      else
+      if ( e == counts.end() )
       {
-        h0 = h1 = h;
+        stack.emplace_back( get_node( g ).E );
       }
     }
-    else /* F.v > min(G.v, H.v) */
+    return counts[f];
+  }
+
+  /* The sets of `f`, each one as its variables in increasing order. */
+  std::vector<std::vector<var_t>> zdd_sets( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    std::vector<std::vector<var_t>> sets;
+    std::vector<var_t> set;
+    /* The pending ZDDs, with the size of `set` when they were reached, and the variable
+     * to add to it (`num_vars()` for none). The ELSE children are visited first. */
+    struct Pending
     {
-      f0 = f1 = f;
-      if ( G.v < H.v )
-      {
-        x = G.v;
-        g0 = G.E;
-        g1 = G.T;
-        h0 = h1 = h;
-      }
-      else if ( H.v < G.v )
+      index_t f;
+      std::size_t size;
+      var_t var;
+    };
+    std::vector<Pending> stack( 1u, Pending( {f, 0u, num_vars()} ) );
+    while ( !stack.empty() )
+    {
+      Pending const pending = stack.back();
+      stack.pop_back();
+      set.resize( pending.size );
+      if ( pending.var != num_vars() )
       {
-        x = H.v;
-        g0 = g1 = g;
-        h0 = H.E;
-        h1 = H.T;
+        set.emplace_back( pending.var );
       }
-      else /* G.v == H.v */
+      if ( pending.f == zdd_empty() || pending.f == zdd_base() )
       {
-        x = G.v;
-        g0 = G.E;
-        g1 = G.T;
-        h0 = H.E;
-        h1 = H.T;
+        if ( pending.f == zdd_base() )
+        {
+          sets.emplace_back( set );
+        }
+        continue;
       }
+      Node const& F = get_node( pending.f );
+      stack.emplace_back( Pending( {F.T, set.size(), F.v} ) );
+      stack.emplace_back( Pending( {F.E, set.size(), num_vars()} ) );
     }
+    return sets;
+  }
+
+  /* The ZDD of the family of the sets of variables assigned 1 by the satisfying assignments of the BDD `f`. */
+  index_t zdd_from_bdd( index_t f )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ZDD_FROM_BDD ); )
+    /* The variables above the top one of `f` are free. */
+    return run_operation( f, 0, 0, [&]() { return zdd_lift( compute( Zdd_From_Bdd_Op( {*this} ), f, 0, 0 ), level( f ), 0u ); } );
+  }
 
-    index_t const r0 = ITE( f0, g0, h0 );
-    index_t const r1 = ITE( f1, g1, h1 );
-    return unique( x, r1, r0 );
+  /* The BDD of the characteristic function of the family `f`: the assignments setting to 1 exactly
+   * the variables of a set of `f`. */
+  index_t zdd_to_bdd( index_t f )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ZDD_TO_BDD ); )
+    return run_operation( f, 0, 0, [&]() { return apply<And_Op>( zdd_absent( 0u, top_index( f ) ), compute( Zdd_To_Bdd_Op( {*this} ), f, 0, 0 ), 0 ); } );
   }
 
   /**********************************************************/
-  /***************** Printing and Evaluating ****************/
+  /************** Algebraic Decision Diagrams ***************/
   /**********************************************************/
+  /* The manager also holds ADDs (or MTBDDs), representing functions from the assignments to real
+   * numbers (e.g., costs, probabilities or delays): their terminals hold arbitrary values, stored in
+   * a terminal value table, and the ADDs of 0 and 1 are the BDD constants `constant( false )` and
+   * `constant( true )`. Like ZDDs, ADDs share the node store, the reference counts, the garbage
+   * collection and the computed table with the BDDs, have their own unique tables, and follow the
+   * order x_0 (top), ..., x_{num_vars - 1}, whatever the order of the BDDs. Edges to ADDs are only
+   * complemented when pointing to 0, and must not be passed to BDD or ZDD operations (nor vice versa). */
 
-  /* Print the BDD rooted at node `f`. */
-  void print( index_t f, std::ostream& os = std::cout ) const
+  /* The constant ADD of `value`, which must not be NaN. */
+  index_t add_constant( double value )
   {
-    for ( auto i = 0u; i < nodes[f].v; ++i )
+    assert( value == value && "Make sure the value is a number." );
+    if ( value == 0.0 || value == 1.0 )
+    {
+      return constant( value == 1.0 );
+    }
+    auto const it = add_terminals.find( value );
+    if ( it != add_terminals.end() )
     {
-      os << "  ";
+      return it->second << 1;
     }
-    if ( f <= 1 )
+    index_t const n = new_node( Node( {0, 0, 0, num_vars(), 0} ) );
+    if ( add_free_values.empty() )
     {
-      os << "node " << f << ": constant " << f << std::endl;
+      nodes[n].next = add_values.size();
+      add_values.emplace_back( value );
     }
     else
     {
-      os << "node " << f << ": var = " << nodes[f].v << ", T = " << nodes[f].T 
-         << ", E = " << nodes[f].E << std::endl;
-      for ( auto i = 0u; i < nodes[f].v; ++i )
-      {
-        os << "  ";
-      }
-      os << "> THEN branch" << std::endl;
-      print( nodes[f].T, os );
-      for ( auto i = 0u; i < nodes[f].v; ++i )
-      {
-        os << "  ";
-      }
-      os << "> ELSE branch" << std::endl;
-      print( nodes[f].E, os );
+      nodes[n].next = add_free_values.back();
+      add_free_values.pop_back();
+      add_values[nodes[n].next] = value;
     }
+    add_terminals.emplace( value, n );
+    return n << 1;
   }
 
-  /* Get the truth table of the BDD rooted at node f. */
-  Truth_Table get_tt( index_t f ) const
+  /* Whether the ADD `f` is constant. */
+  bool is_add_constant( index_t f ) const
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-    assert( num_vars() <= 6 && "Truth_Table only supports functions of no greater than 6 variables." );
+    return top_index( f ) == num_vars();
+  }
 
-    if ( f == constant( false ) )
-    {
-      return Truth_Table( num_vars() );
-    }
-    else if ( f == constant( true ) )
+  /* The value of the constant ADD `f`. */
+  double add_value( index_t f ) const
+  {
+    assert( is_add_constant( f ) && "Make sure f is constant." );
+    if ( ( f >> 1 ) == 0 )
     {
-      return ~Truth_Table( num_vars() );
+      return f == constant( true ) ? 1.0 : 0.0;
     }
-    
-    /* Shannon expansion: f = x f_x + x' f_x' */
-    var_t const x = nodes[f].v;
-    index_t const fx = nodes[f].T;
-    index_t const fnx = nodes[f].E;
-    Truth_Table const tt_x = create_tt_nth_var( num_vars(), x );
-    Truth_Table const tt_nx = create_tt_nth_var( num_vars(), x, false );
-    return ( tt_x & get_tt( fx ) ) | ( tt_nx & get_tt( fnx ) );
+    return add_values[get_node( f ).next];
   }
 
-  /* Whether `f` is dead (having a reference count of 0). */
-  bool is_dead( index_t f ) const
+  /* Look up (if exist) or build (if not) the ADD node with variable `var`, THEN child `T` and ELSE child `E`. */
+  index_t add_unique( var_t var, index_t T, index_t E )
   {
-    /* TODO */
-    return false;
-  }
+    assert( var < num_vars() && "Variables range from 0 to `num_vars - 1`." );
+    assert( ( T >> 1 ) < nodes.size() && "Make sure the children exist." );
+    assert( ( E >> 1 ) < nodes.size() && "Make sure the children exist." );
+    assert( top_index( T ) > var && top_index( E ) > var && "Children can only be below the node." );
 
-  /* Get the number of living nodes in the whole package, excluding constants. */
-  uint64_t num_nodes() const
-  {
-    uint64_t n = 0u;
-    for ( auto i = 2u; i < nodes.size(); ++i )
+    /* Reduction rule: Identical children */
+    if ( T == E )
     {
-      if ( !is_dead( i ) )
-      {
-        ++n;
-      }
+      return T;
     }
-    return n;
+    return find_or_add( add_table[var], var, T, E );
   }
 
-  /* Get the number of nodes in the sub-graph rooted at node f, excluding constants. */
-  uint64_t num_nodes( index_t f ) const
+  /* The value of the ADD `f` under `assignment` (with a value for every variable). */
+  double add_evaluate( index_t f, std::vector<bool> const& assignment ) const
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-
-    if ( f == constant( false ) || f == constant( true ) )
+    assert( assignment.size() == num_vars() && "Make sure every variable is assigned." );
+    while ( !is_add_constant( f ) )
     {
-      return 0u;
+      f = assignment[top_index( f )] ? get_node( f ).T : get_node( f ).E;
+    }
+    return add_value( f );
+  }
+
+  /* Compute f + g */
+  index_t add_plus( index_t f, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ADD_PLUS ); )
+    return run_operation( f, g, 0, [&]() { return add_apply<Add_Plus_Op>( f, g ); } );
+  }
+
+  /* Compute f * g */
+  index_t add_times( index_t f, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ADD_TIMES ); )
+    return run_operation( f, g, 0, [&]() { return add_apply<Add_Times_Op>( f, g ); } );
+  }
+
+  /* Compute min( f, g ) */
+  index_t add_min( index_t f, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ADD_MIN ); )
+    return run_operation( f, g, 0, [&]() { return add_apply<Add_Min_Op>( f, g ); } );
+  }
+
+  /* Compute max( f, g ) */
+  index_t add_max( index_t f, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ADD_MAX ); )
+    return run_operation( f, g, 0, [&]() { return add_apply<Add_Max_Op>( f, g ); } );
+  }
+
+  /* Compute f >= g, i.e., the ADD that is 1 where f >= g and 0 elsewhere. */
+  index_t add_threshold( index_t f, index_t g )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ADD_THRESHOLD ); )
+    return run_operation( f, g, 0, [&]() { return add_apply<Add_Threshold_Op>( f, g ); } );
+  }
+
+  /* Compute the sum of the cofactors of `f` over all assignments of the variables in `cube`, the
+   * conjunction of their positive BDD literals (as for `exists`). */
+  index_t add_sum_abstract( index_t f, index_t cube )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ADD_SUM_ABSTRACT ); )
+    return run_operation( f, cube, 0, [&]() { return compute( Add_Abstract_Op<true>( {*this} ), f, add_cube( cube ), 0 ); } );
+  }
+
+  /* Compute the maximum of the cofactors of `f` over all assignments of the variables in `cube`. */
+  index_t add_max_abstract( index_t f, index_t cube )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ADD_MAX_ABSTRACT ); )
+    return run_operation( f, cube, 0, [&]() { return compute( Add_Abstract_Op<false>( {*this} ), f, add_cube( cube ), 0 ); } );
+  }
+
+  /* The 0-1 ADD of the BDD `f`. */
+  index_t add_from_bdd( index_t f )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ADD_FROM_BDD ); )
+    return run_operation( f, 0, 0, [&]() { return compute( Add_From_Bdd_Op( {*this} ), f, 0, 0 ); } );
+  }
+
+  /* The BDD of the assignments where the value of the ADD `f` is at least `threshold`. */
+  index_t add_to_bdd( index_t f, double threshold )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ADD_TO_BDD ); )
+    return run_operation( f, 0, 0, [&]() { return compute( Add_To_Bdd_Op( {*this} ), f, add_constant( threshold ), 0 ); } );
+  }
+
+  /**********************************************************/
+  /******** Reference Counting and Garbage Collection *******/
+  /**********************************************************/
+
+  /* Reference `f`, i.e., keep it (and its sub-graph) alive.
+   * Returns `f` for convenience: `auto const g = bdd.ref( bdd.AND( a, b ) );`.
+   *
+   * Results of the operations are dead (unreferenced) when returned. They
+   * remain valid until the next garbage collection, which only happens at
+   * the beginning of an operation, so they should be referenced before
+   * invoking further operations unless they are passed as operands. */
+  index_t ref( index_t f )
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+
+    if ( ( f >> 1 ) == 0 || !add_ref( f >> 1 ) )
+    {
+      return f;
+    }
+
+    /* `f` comes to life, and so do its children (transitively, if they were dead). */
+    std::vector<index_t> stack( 1u, f >> 1 );
+    while ( !stack.empty() )
+    {
+      Node const& N = nodes[stack.back()];
+      stack.pop_back();
+      --num_dead;
+      for ( auto const child : {N.T >> 1, N.E >> 1} )
+      {
+        if ( child != 0 && add_ref( child ) )
+        {
+          stack.emplace_back( child );
+        }
+      }
+    }
+    BDD_INSTRUMENT( instr.peak_live_nodes = std::max( instr.peak_live_nodes, num_live_nodes() ); )
+    return f;
+  }
+
+  /* Dereference `f`, i.e., drop a reference previously taken by `ref`. */
+  void deref( index_t f )
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+
+    if ( ( f >> 1 ) == 0 )
+    {
+      return;
+    }
+    assert( nodes[f >> 1].ref > 0 && "Make sure f was referenced before." );
+    if ( !drop_ref( f >> 1 ) )
+    {
+      return;
+    }
+
+    /* `f` dies and drops its references to its children (transitively, if they die too). */
+    std::vector<index_t> stack( 1u, f >> 1 );
+    while ( !stack.empty() )
+    {
+      Node const& N = nodes[stack.back()];
+      stack.pop_back();
+      ++num_dead;
+      for ( auto const child : {N.T >> 1, N.E >> 1} )
+      {
+        if ( child != 0 && drop_ref( child ) )
+        {
+          stack.emplace_back( child );
+        }
+      }
+    }
+  }
+
+  /* Remove all dead nodes from the unique table and the computed table.
+   * Their slots are recycled by `unique`. All edges to dead nodes become invalid. */
+  void garbage_collect()
+  {
+    BDD_INSTRUMENT( auto const start = std::chrono::steady_clock::now(); )
+    for ( auto& table : unique_table )
+    {
+      unlink_dead( table );
+    }
+    for ( auto& table : zdd_table )
+    {
+      unlink_dead( table );
+    }
+    for ( auto& table : add_table )
+    {
+      unlink_dead( table );
+    }
+    /* The ADD terminals are not in the unique tables. */
+    for ( auto it = add_terminals.begin(); it != add_terminals.end(); )
+    {
+      Node& N = nodes[it->second];
+      if ( N.ref == 0 )
+      {
+        add_free_values.emplace_back( N.next );
+        N.v = free_var();
+        free_list.emplace_back( it->second );
+        it = add_terminals.erase( it );
+      }
+      else
+      {
+        ++it;
+      }
+    }
+
+    /* Drop the computed table entries mentioning a recycled node. */
+    for ( auto& entry : computed_table )
+    {
+      if ( entry.op != OP_NONE && is_stale( entry ) )
+      {
+        entry.op = OP_NONE;
+      }
+    }
+
+    num_dead = 0u;
+    ++num_gc;
+    BDD_INSTRUMENT( double const seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count(); ++instr.num_gc;
+                    instr.gc_seconds += seconds; instr.max_gc_seconds = std::max( instr.max_gc_seconds, seconds ); )
+  }
+
+  /* Set when garbage collection is triggered automatically: at the beginning of an operation,
+   * if there are at least `min_dead` dead nodes and they make up at least `dead_ratio` of all nodes.
+   * Use a `dead_ratio` greater than 1 to disable automatic garbage collection. */
+  void set_gc_threshold( double dead_ratio, uint64_t min_dead = 1u << 16 )
+  {
+    gc_dead_ratio = dead_ratio;
+    gc_min_dead = min_dead;
+  }
+
+  /**********************************************************/
+  /******************* Variable Reordering ******************/
+  /**********************************************************/
+
+  /* The level (position in the variable order, 0 being the top) of variable `var`. */
+  uint32_t level_of( var_t var ) const
+  {
+    assert( var < num_vars() && "Variables range from 0 to `num_vars - 1`." );
+    return var2level[var];
+  }
+
+  /* The variable at level `l`. */
+  var_t var_at_level( uint32_t l ) const
+  {
+    assert( l < num_vars() && "Levels range from 0 to `num_vars - 1`." );
+    return level2var[l];
+  }
+
+  /* Exchange the variables at levels `l` and `l + 1`.
+   * The nodes are rewritten in place: every living edge keeps representing the same function.
+   * Dead nodes are collected and the computed table is cleared first. */
+  void swap_levels( uint32_t l )
+  {
+    assert( l + 1 < num_vars() && "Levels range from 0 to `num_vars - 1`." );
+    if ( num_dead != 0u )
+    {
+      garbage_collect();
+    }
+    clear_cache();
+    swap_adjacent( l );
+  }
+
+  /* Reorder the variables with Rudell's sifting algorithm to reduce the number of living nodes.
+   * Every variable, starting with the one with most nodes, is moved through all levels (as long as
+   * the size does not exceed `max_growth` times the best size seen) and then left at the best level.
+   * Edges to dead nodes become invalid; living edges keep representing the same function. */
+  void reorder()
+  {
+    garbage_collect();
+    clear_cache();
+
+    std::vector<var_t> vars( num_vars() );
+    for ( var_t v = 0u; v < num_vars(); ++v )
+    {
+      vars[v] = v;
+    }
+    std::stable_sort( vars.begin(), vars.end(), [this]( var_t a, var_t b ) {
+      return unique_table[a].num_entries > unique_table[b].num_entries;
+    } );
+    for ( auto const v : vars )
+    {
+      sift( v );
+    }
+
+    ++num_reorder;
+    next_reorder = std::max<uint64_t>( next_reorder, 2u * num_live_nodes() );
+  }
+
+  /* Improve the variable order by window permutation: for each group of `window` (2 or 3)
+   * adjacent levels, try all their permutations and keep the smallest one. */
+  void reorder_window( uint32_t window = 3u )
+  {
+    assert( ( window == 2u || window == 3u ) && "Only windows of 2 or 3 levels are supported." );
+    garbage_collect();
+    clear_cache();
+
+    for ( uint32_t l = 0u; l + window <= num_vars(); ++l )
+    {
+      /* Alternating the two swaps of a 3-level window walks through all 6 permutations
+       * and comes back to the initial one; a 2-level window has a single swap. */
+      uint32_t const steps = window == 2u ? 2u : 6u;
+      uint64_t best_size = num_live_nodes();
+      uint32_t best_step = 0u;
+      for ( uint32_t step = 1u; step <= steps; ++step )
+      {
+        swap_adjacent( l + ( ( step - 1u ) & 1u ) );
+        if ( num_live_nodes() < best_size )
+        {
+          best_size = num_live_nodes();
+          best_step = step;
+        }
+      }
+      for ( uint32_t step = 1u; step <= best_step; ++step )
+      {
+        swap_adjacent( l + ( ( step - 1u ) & 1u ) );
+      }
+    }
+
+    ++num_reorder;
+  }
+
+  /* Configure reordering. If `automatic`, `reorder` is triggered at the beginning of an operation
+   * whenever the number of living nodes has doubled since the last reordering (4096 nodes at least).
+   * `growth` bounds the size relative to the best one found while sifting a variable. */
+  void set_reordering( bool automatic, double growth = 1.2 )
+  {
+    auto_reorder = automatic;
+    max_growth = growth;
+  }
+
+  /**********************************************************/
+  /******************** Parallel Operations *****************/
+  /**********************************************************/
+
+  /* Use `n` threads (including the calling one) for AND, OR, XOR and ITE.
+   * With more than one thread, the two cofactor computations of the calls in the top
+   * `spawn_depth` levels of the recursion are run as tasks on a work-stealing pool, and
+   * the calls below them are computed sequentially by the thread running the task.
+   * All threads share the unique table (inserting with compare-and-swap) and the computed
+   * table (lossy, see `cache_insert_concurrent`). The manager itself must still be used
+   * from one thread at a time. */
+  void set_num_threads( uint32_t n, uint32_t spawn_depth = 10u )
+  {
+    pool.reset( n > 1u ? new Work_Stealing_Pool( n ) : nullptr );
+    workers.assign( n > 1u ? n : 0u, Worker_Context() );
+    max_spawn_depth = spawn_depth;
+  }
+
+  uint32_t num_threads() const
+  {
+    return pool ? pool->num_threads() : 1u;
+  }
+
+  /**********************************************************/
+  /***************** Satisfying Assignments *****************/
+  /**********************************************************/
+
+  /* A partial assignment, indexed by variable: 1 (true), 0 (false) or -1 (unassigned). */
+  using Cube = std::vector<int8_t>;
+
+  /* Number of assignments of all `num_vars()` variables satisfying `f`, exact up to 2^64.
+   * Managers with too many variables for a `long double` fall back to `log2_sat_count`. */
+  long double sat_count( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    if ( num_vars() >= uint32_t( std::numeric_limits<long double>::max_exponent ) )
+    {
+      return std::exp2( log2_sat_count( f ) );
+    }
+    std::unordered_map<index_t, long double> counts;
+    return std::ldexp( sat_count_below( f, counts ), level( f ) );
+  }
+
+  /* Base-2 logarithm of `sat_count( f )` (minus infinity if `f` is unsatisfiable), without overflow. */
+  long double log2_sat_count( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    std::unordered_map<index_t, std::pair<long double, long double>> fractions;
+    return num_vars() + log2_fraction( f, fractions );
+  }
+
+  /* A cube of `f` (a path to constant 1), or an empty vector if `f` is unsatisfiable.
+   * Variables not on the path are unassigned. */
+  Cube any_sat( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    if ( f == constant( false ) )
+    {
+      return Cube();
+    }
+    Cube cube( num_vars(), -1 );
+    while ( f != constant( true ) )
+    {
+      /* Every non-constant edge has a child different from constant 0. */
+      Node const& F = get_node( f );
+      bool const value = ( F.E ^ ( f & 1 ) ) == constant( false );
+      cube[F.v] = value;
+      f = ( value ? F.T : F.E ) ^ ( f & 1 );
+    }
+    return cube;
+  }
+
+  /* Enumerates the cubes of the disjoint cover of a function given by the paths to constant 1
+   * (or, expanding the unassigned variables, its minterms) one at a time, in depth-first order.
+   * The manager must not be modified (e.g., garbage collected) during the enumeration. */
+  class Sat_Iterator
+  {
+  public:
+    /* The end iterator. */
+    Sat_Iterator()
+      : manager( nullptr ), root( 0 ), minterms( false ), done( true )
+    {
+    }
+
+    Cube const& operator*() const
+    {
+      return minterms ? minterm : cube;
+    }
+
+    Cube const* operator->() const
+    {
+      return &**this;
+    }
+
+    Sat_Iterator& operator++()
+    {
+      if ( !minterms || !next_minterm() )
+      {
+        next_path( true );
+      }
+      return *this;
+    }
+
+    bool operator==( Sat_Iterator const& other ) const
+    {
+      return done == other.done;
+    }
+
+    bool operator!=( Sat_Iterator const& other ) const
+    {
+      return !( *this == other );
+    }
+
+  private:
+    friend class Basic_BDD;
+
+    Sat_Iterator( Basic_BDD const* manager, index_t f, bool minterms )
+      : manager( manager ), root( f ), minterms( minterms ), done( false ), cube( manager->num_vars(), -1 )
+    {
+      next_path( false );
+    }
+
+    /* Move to the next path to constant 1, after the current one if `resume`. */
+    void next_path( bool resume )
+    {
+      index_t f = root;
+      while ( true )
+      {
+        if ( resume )
+        {
+          /* Backtrack to the deepest ELSE branch and take its THEN branch instead. */
+          resume = false;
+          while ( !stack.empty() && stack.back().second )
+          {
+            cube[manager->get_node( stack.back().first ).v] = -1;
+            stack.pop_back();
+          }
+          if ( stack.empty() )
+          {
+            done = true;
+            return;
+          }
+          stack.back().second = true;
+          Node const& F = manager->get_node( stack.back().first );
+          cube[F.v] = 1;
+          f = F.T ^ ( stack.back().first & 1 );
+        }
+
+        /* Descend along ELSE branches. */
+        while ( f != constant( false ) && f != constant( true ) )
+        {
+          Node const& F = manager->get_node( f );
+          stack.emplace_back( f, false );
+          cube[F.v] = 0;
+          f = F.E ^ ( f & 1 );
+        }
+        if ( f == constant( true ) )
+        {
+          minterm = cube;
+          std::replace( minterm.begin(), minterm.end(), int8_t( -1 ), int8_t( 0 ) );
+          return;
+        }
+        if ( stack.empty() )
+        {
+          done = true;
+          return;
+        }
+        resume = true;
+      }
+    }
+
+    /* Count the unassigned variables of the cube in binary. Returns false on overflow. */
+    bool next_minterm()
+    {
+      for ( auto v = 0u; v < cube.size(); ++v )
+      {
+        if ( cube[v] == -1 )
+        {
+          if ( minterm[v] == 0 )
+          {
+            minterm[v] = 1;
+            return true;
+          }
+          minterm[v] = 0;
+        }
+      }
+      return false;
+    }
+
+  private:
+    Basic_BDD const* manager;
+    index_t root;
+    bool minterms; /* whether to expand the cubes into minterms */
+    bool done;
+    std::vector<std::pair<index_t, bool>> stack; /* edges on the path, and whether the THEN branch was taken */
+    Cube cube;
+    Cube minterm;
+  };
+
+  /* Range of the `Sat_Iterator`s over the cubes or the minterms of a function. */
+  struct Sat_Range
+  {
+    Sat_Iterator first;
+
+    Sat_Iterator begin() const
+    {
+      return first;
+    }
+
+    Sat_Iterator end() const
+    {
+      return Sat_Iterator();
+    }
+  };
+
+  /* The cubes of `f`, e.g., `for ( auto const& cube : bdd.cubes( f ) ) { ... }`. They are disjoint. */
+  Sat_Range cubes( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    return Sat_Range( {Sat_Iterator( this, f, false )} );
+  }
+
+  /* The satisfying assignments of all `num_vars()` variables (with no -1 entries). */
+  Sat_Range minterms( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    return Sat_Range( {Sat_Iterator( this, f, true )} );
+  }
+
+  /* Draw `num_samples` satisfying assignments of `f` uniformly at random (with replacement).
+   * After one counting pass, each sample follows a path from `f`, taking each branch with a
+   * probability proportional to its number of solutions. Returns no sample if `f` is unsatisfiable. */
+  template<typename Rng>
+  std::vector<std::vector<bool>> sample_sat( index_t f, uint64_t num_samples, Rng& rng ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    std::vector<std::vector<bool>> samples;
+    if ( f == constant( false ) )
+    {
+      return samples;
+    }
+
+    std::unordered_map<index_t, std::pair<long double, long double>> fractions;
+    log2_fraction( f, fractions );
+    auto const log2_of = [&]( index_t g ) {
+      auto const& fraction = fractions.at( g >> 1 );
+      return is_complemented( g ) ? fraction.second : fraction.first;
+    };
+
+    std::uniform_real_distribution<double> uniform( 0.0, 1.0 );
+    std::bernoulli_distribution coin( 0.5 );
+    for ( uint64_t i = 0u; i < num_samples; ++i )
+    {
+      std::vector<bool> sample( num_vars() );
+      index_t g = f;
+      for ( uint32_t l = 0u; l < num_vars(); ++l )
+      {
+        var_t const x = level2var[l];
+        if ( level( g ) != l )
+        {
+          sample[x] = coin( rng );
+          continue;
+        }
+        index_t g0, g1;
+        cofactors( g, x, g0, g1 );
+        /* P( x = 1 ) = |g1| / ( |g0| + |g1| ) = 1 / ( 1 + 2^( log2 |g0| - log2 |g1| ) ) */
+        long double const p1 = g0 == constant( false ) ? 1.0 : g1 == constant( false ) ? 0.0
+                                                                                      : 1.0 / ( 1.0 + std::exp2( log2_of( g0 ) - log2_of( g1 ) ) );
+        sample[x] = uniform( rng ) < p1;
+        g = sample[x] ? g1 : g0;
+      }
+      samples.emplace_back( std::move( sample ) );
+    }
+    return samples;
+  }
+
+  /**********************************************************/
+  /*********** Irredundant Sums of Products (ISOP) **********/
+  /**********************************************************/
+  /* The functions below compute the irredundant sum-of-products cover of Minato and Morreale of
+   * a function in the interval [lower, upper], i.e., `lower` is the on-set and `upper` the
+   * complement of the off-set (`lower` must imply `upper`): every cube is an implicant of `upper`,
+   * the cubes cover `lower`, and no cube can be removed. The BDDs of the covers are cached in
+   * the computed table and the cube counts memoized per call; the cubes are enumerated, in time
+   * proportional to their number. */
+
+  /* The BDD of the ISOP cover of [lower, upper]. */
+  index_t isop( index_t lower, index_t upper )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ISOP ); )
+    assert( implies( lower, upper ) && "Make sure lower implies upper." );
+    return run_operation( lower, upper, 0, [&]() { return compute( Isop_Op( {*this, nullptr, nullptr} ), lower, upper, 0 ); } );
+  }
+
+  /* The cubes of the ISOP cover of [lower, upper]. */
+  std::vector<Cube> isop_cubes( index_t lower, index_t upper )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ISOP ); )
+    assert( implies( lower, upper ) && "Make sure lower implies upper." );
+    std::vector<Cube> cubes;
+    run_operation( lower, upper, 0, [&]() {
+      Cube cube( num_vars(), -1 );
+      cubes.clear();
+      return compute( Isop_Op( {*this, &cube, &cubes} ), lower, upper, 0 );
+    } );
+    return cubes;
+  }
+
+  /* Number of cubes of the ISOP cover of [lower, upper], without enumerating them: the count of
+   * each subproblem is the sum of the counts of its three subproblems (see `Isop_Op`), memoized. */
+  uint64_t isop_num_cubes( index_t lower, index_t upper )
+  {
+    BDD_INSTRUMENT( Latency_Timer const timer( *this, OP_ISOP ); )
+    assert( implies( lower, upper ) && "Make sure lower implies upper." );
+    uint64_t num_cubes = 0u;
+    run_operation( lower, upper, 0, [&]() {
+      num_cubes = isop_count( lower, upper );
+      return 0;
+    } );
+    return num_cubes;
+  }
+
+  /**********************************************************/
+  /********************** Serialization *********************/
+  /**********************************************************/
+  /* Named functions, e.g., the outputs of a circuit. */
+  using Named_Roots = std::vector<std::pair<std::string, index_t>>;
+
+  /* Write the BDDs of `roots` in a compact binary format: a header (magic number, version,
+   * variable order), the nodes reachable from the roots level by level from the bottom, and the
+   * roots with their names. Children precede their parents, so each child is stored as the
+   * (variable-length encoded) distance back to it, which is usually small. */
+  void save( std::ostream& os, Named_Roots const& roots ) const
+  {
+    std::vector<std::vector<index_t>> by_level( num_vars() );
+    std::unordered_map<index_t, uint64_t> position( {{0u, 0u}} );
+    for ( auto const& root : roots )
+    {
+      assert( ( root.second >> 1 ) < nodes.size() && "Make sure the roots exist." );
+      std::vector<index_t> stack( 1u, root.second >> 1 );
+      while ( !stack.empty() )
+      {
+        index_t const n = stack.back();
+        stack.pop_back();
+        if ( position.emplace( n, 0u ).second )
+        {
+          by_level[var2level[nodes[n].v]].emplace_back( n );
+          stack.emplace_back( nodes[n].T >> 1 );
+          stack.emplace_back( nodes[n].E >> 1 );
+        }
+      }
+    }
+
+    os.write( file_magic(), 4 );
+    write_varint( os, file_version() );
+    write_varint( os, num_vars() );
+    for ( var_t l = 0u; l < num_vars(); ++l )
+    {
+      write_varint( os, level2var[l] );
+    }
+    uint64_t k = 0u;
+    for ( auto l = num_vars(); l-- > 0u; )
+    {
+      write_varint( os, by_level[l].size() );
+      for ( auto const n : by_level[l] )
+      {
+        position[n] = ++k;
+        write_varint( os, k - position[nodes[n].T >> 1] );
+        write_varint( os, ( ( k - position[nodes[n].E >> 1] ) << 1 ) | ( nodes[n].E & 1 ) );
+      }
+    }
+    write_varint( os, roots.size() );
+    for ( auto const& root : roots )
+    {
+      write_varint( os, root.first.size() );
+      os.write( root.first.data(), root.first.size() );
+      write_varint( os, ( position[root.second >> 1] << 1 ) | ( root.second & 1 ) );
+    }
+    if ( !os )
+    {
+      throw std::runtime_error( "cannot write the BDDs" );
+    }
+  }
+
+  /* Write the BDDs of `roots` into the file `filename` (see above). */
+  void save( std::string const& filename, Named_Roots const& roots ) const
+  {
+    std::ofstream os( filename, std::ios::binary );
+    if ( !os )
+    {
+      throw std::runtime_error( "cannot open " + filename );
+    }
+    save( os, roots );
+  }
+
+  /* Read the BDDs written by `save` from `size` bytes at `data`. The roots are returned referenced.
+   * The file must not have more variables than the manager; variable `v` of the file is `v` here.
+   *
+   * The nodes are rebuilt through `unique` if the manager has the variable order of the file,
+   * and through `ITE` otherwise. If the manager is also empty, the unique table is sized for the
+   * file up front, and since `save` writes no two equal nodes, a node equal to an earlier one is
+   * rejected. Loading is subject to the memory limit, like the operations (see `set_memory_limit`).
+   * Throws `std::runtime_error` if the data is not a valid file. */
+  Named_Roots load( uint8_t const* data, uint64_t size )
+  {
+    uint8_t const* const end = data + size;
+    if ( size < 4u || std::memcmp( data, file_magic(), 4 ) != 0 )
+    {
+      throw std::runtime_error( "not a BDD file" );
+    }
+    data += 4;
+    if ( read_varint( data, end ) != file_version() )
+    {
+      throw std::runtime_error( "unsupported BDD file version" );
+    }
+    uint64_t const file_vars = read_varint( data, end );
+    if ( file_vars > num_vars() )
+    {
+      throw std::runtime_error( "the BDD file has too many variables" );
+    }
+    std::vector<var_t> order;
+    bool same_order = file_vars == num_vars();
+    for ( uint64_t l = 0u; l < file_vars; ++l )
+    {
+      uint64_t const v = read_varint( data, end );
+      if ( v >= file_vars )
+      {
+        throw std::runtime_error( "invalid variable in the BDD file" );
+      }
+      order.emplace_back( v );
+      same_order &= level2var[l] == v;
+    }
+    bool const bulk = same_order && num_live_nodes() + num_dead == 0u;
+
+    uint8_t const* const levels = data;
+    std::vector<index_t> edges; /* the edge built for each node of the file */
+    run_operation( 0, 0, 0, [&]() {
+      /* After a garbage collection, start over: the nodes built so far were dead. */
+      data = levels;
+      edges.assign( 1u, constant( true ) );
+      for ( auto l = file_vars; l-- > 0u; )
+      {
+        var_t const v = order[l];
+        uint64_t const count = read_varint( data, end );
+        if ( count > uint64_t( end - data ) / 2u )
+        {
+          throw std::runtime_error( "truncated BDD file" );
+        }
+        if ( bulk && count > unique_table[v].buckets.size() )
+        {
+          uint64_t buckets = unique_table[v].buckets.size();
+          while ( buckets < count )
+          {
+            buckets <<= 1;
+          }
+          resize_subtable( unique_table[v], buckets );
+        }
+        uint64_t const first = edges.size(); /* the children are below this level, i.e., before `first` */
+        for ( uint64_t i = 0u; i < count; ++i )
+        {
+          uint64_t const k = edges.size();
+          uint64_t const t = read_varint( data, end );
+          uint64_t const e = read_varint( data, end );
+          if ( t < k - first + 1u || t > k || ( e >> 1 ) < k - first + 1u || ( e >> 1 ) > k || e == ( t << 1 ) )
+          {
+            throw std::runtime_error( "invalid node in the BDD file" );
+          }
+          index_t const T = edges[k - t];
+          index_t const E = edges[k - ( e >> 1 )] ^ ( e & 1 );
+          if ( same_order )
+          {
+            uint64_t const num_entries = unique_table[v].num_entries;
+            edges.emplace_back( unique( v, T, E ) );
+            if ( bulk && unique_table[v].num_entries == num_entries )
+            {
+              throw std::runtime_error( "duplicate node in the BDD file" );
+            }
+          }
+          else
+          {
+            edges.emplace_back( apply<Ite_Op>( literal( v ), T, E ) );
+          }
+        }
+      }
+      return constant( true );
+    } );
+
+    uint64_t const num_roots = read_varint( data, end );
+    if ( num_roots > uint64_t( end - data ) / 2u )
+    {
+      throw std::runtime_error( "truncated BDD file" );
+    }
+    Named_Roots roots( num_roots );
+    for ( auto& root : roots )
+    {
+      uint64_t const length = read_varint( data, end );
+      if ( uint64_t( end - data ) < length )
+      {
+        throw std::runtime_error( "truncated BDD file" );
+      }
+      root.first.assign( reinterpret_cast<char const*>( data ), length );
+      data += length;
+      uint64_t const r = read_varint( data, end );
+      if ( ( r >> 1 ) >= edges.size() )
+      {
+        throw std::runtime_error( "invalid root in the BDD file" );
+      }
+      root.second = edges[r >> 1] ^ ( r & 1 );
+    }
+    for ( auto& root : roots )
+    {
+      ref( root.second );
+    }
+    return roots;
+  }
+
+  /* Read the BDDs written by `save` from the file `filename`, which is mapped into memory
+   * rather than read (see above). */
+  Named_Roots load( std::string const& filename )
+  {
+    Mapped_File const file( filename );
+    return load( file.data(), file.size() );
+  }
+
+  /**********************************************************/
+  /***************** Printing and Evaluating ****************/
+  /**********************************************************/
+
+  /* Evaluate the BDDs rooted at `roots` on `num_words` words of input patterns, given bit-sliced:
+   * `patterns[v * num_words + w]` holds the values of variable `v` in the patterns of word `w`
+   * (64 per `uint64_t`, or 512 per `Word512`). The values of root `r` are written, in the same
+   * layout, to `results[r * num_words + w]`.
+   *
+   * The nodes below the roots are compiled once into a list ordered bottom-up; each word of
+   * patterns is then pushed through the list in one sweep, shared by all roots, computing
+   * x ? T : E on whole words. */
+  template<typename Word>
+  void evaluate( std::vector<index_t> const& roots, Word const* patterns, uint64_t num_words, Word* results ) const
+  {
+    /* Each instruction computes the value of a node from the values of its children, given by
+     * their positions in the list (0 is the constant 1) and complement attributes. */
+    struct Instruction
+    {
+      var_t v;
+      index_t T, E;
+    };
+    std::unordered_map<index_t, index_t> position( {{0u, 0u}} );
+    std::vector<index_t> order;
+    for ( auto const root : roots )
+    {
+      assert( ( root >> 1 ) < nodes.size() && "Make sure the roots exist." );
+      std::vector<index_t> stack( 1u, root >> 1 );
+      while ( !stack.empty() )
+      {
+        index_t const n = stack.back();
+        stack.pop_back();
+        if ( position.emplace( n, 0u ).second )
+        {
+          order.emplace_back( n );
+          stack.emplace_back( nodes[n].T >> 1 );
+          stack.emplace_back( nodes[n].E >> 1 );
+        }
+      }
+    }
+    std::sort( order.begin(), order.end(), [&]( index_t a, index_t b ) { return var2level[nodes[a].v] > var2level[nodes[b].v]; } );
+    std::vector<Instruction> program;
+    for ( auto const n : order )
+    {
+      position[n] = program.size() + 1u;
+      Node const& N = nodes[n];
+      program.emplace_back( Instruction( {N.v, ( position[N.T >> 1] << 1 ) | ( N.T & 1 ), ( position[N.E >> 1] << 1 ) | ( N.E & 1 )} ) );
+    }
+
+    std::vector<index_t> outputs;
+    for ( auto const root : roots )
+    {
+      outputs.emplace_back( ( position[root >> 1] << 1 ) | ( root & 1 ) );
+    }
+
+    /* complementing is XOR with an all-zero or all-one mask, which avoids a branch per edge */
+    Word one;
+    std::memset( &one, 0xff, sizeof( Word ) );
+    std::vector<Word> values( program.size() + 1u, one );
+    for ( uint64_t w = 0u; w < num_words; ++w )
+    {
+      for ( auto i = 0u; i < program.size(); ++i )
+      {
+        Instruction const& I = program[i];
+        values[i + 1u] = mux( patterns[I.v * num_words + w], values[I.T >> 1], -uint64_t( I.T & 1 ), values[I.E >> 1], -uint64_t( I.E & 1 ) );
+      }
+      for ( auto r = 0u; r < outputs.size(); ++r )
+      {
+        results[r * num_words + w] = mux( one, values[outputs[r] >> 1], -uint64_t( outputs[r] & 1 ), one, 0u );
+      }
+    }
+  }
+
+  /* Evaluate `f` on 64 input patterns per word (see above): `patterns` holds `num_vars()` blocks
+   * of the same number of words. Returns one bit per pattern, in the same layout. */
+  std::vector<uint64_t> evaluate( index_t f, std::vector<uint64_t> const& patterns ) const
+  {
+    assert( patterns.size() % std::max( num_vars(), 1u ) == 0u && "Make sure every variable has the same number of patterns." );
+    uint64_t const num_words = num_vars() == 0u ? 0u : patterns.size() / num_vars();
+    std::vector<uint64_t> results( num_words );
+    evaluate( std::vector<index_t>( 1u, f ), patterns.data(), num_words, results.data() );
+    return results;
+  }
+
+  /* Print the BDD rooted at node `f`.
+   * Complemented edges are printed with a leading `~`. */
+  void print( index_t f, std::ostream& os = std::cout ) const
+  {
+    /* Work list of the lines to print, in reverse order: either the sub-graph
+     * rooted at an edge (`label == nullptr`) or a branch label line. */
+    struct Item
+    {
+      index_t f;
+      uint32_t indent;
+      char const* label;
+    };
+    std::vector<Item> stack( 1u, Item( {f, level( f ), nullptr} ) );
+    while ( !stack.empty() )
+    {
+      Item const item = stack.back();
+      stack.pop_back();
+      for ( auto i = 0u; i < item.indent; ++i )
+      {
+        os << "  ";
+      }
+      if ( item.label != nullptr )
+      {
+        os << item.label << std::endl;
+        continue;
+      }
+
+      Node const& F = get_node( item.f );
+      if ( ( item.f >> 1 ) == 0 )
+      {
+        os << "node " << edge_name( item.f ) << ": constant " << ( item.f == constant( true ) ? 1 : 0 ) << std::endl;
+        continue;
+      }
+      os << "node " << edge_name( item.f ) << ": var = " << F.v << ", T = " << edge_name( F.T )
+         << ", E = " << edge_name( F.E ) << std::endl;
+      index_t const c = item.f & 1;
+      stack.emplace_back( Item( {F.E ^ c, level( F.E ), nullptr} ) );
+      stack.emplace_back( Item( {0, item.indent, "> ELSE branch"} ) );
+      stack.emplace_back( Item( {F.T ^ c, level( F.T ), nullptr} ) );
+      stack.emplace_back( Item( {0, item.indent, "> THEN branch"} ) );
+    }
+  }
+
+  /* Get the truth table of the BDD rooted at node f. */
+  Truth_Table get_tt( index_t f ) const
+  {
+    std::vector<uint64_t> words( Truth_Table::num_words( num_vars() ) );
+    get_tt( f, words.data() );
+    return Truth_Table( num_vars(), std::move( words ) );
+  }
+
+  /* Write the truth table of the BDD rooted at node f into `words`, laid out as `Truth_Table::bits`
+   * (`Truth_Table::num_words( num_vars() )` words), without allocating any table.
+   * Takes time linear in the size of the table and in the number of nodes. */
+  void get_tt( index_t f, uint64_t* words ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    assert( num_vars() <= 32u && "Make sure the truth table fits in memory." );
+
+    /* The table is first built with the variables ordered by level, the top one being the
+     * most significant: the sub-function of a node at level l is then a contiguous block of
+     * 2^(num_vars - l) bits, so each node is expanded once and its other occurrences copy
+     * the block (see `tt_fill`). The variables are finally swapped into their positions. */
+    uint32_t const n = num_vars();
+    std::unordered_map<index_t, uint64_t> small_tables;
+    std::unordered_map<index_t, std::pair<uint64_t const*, index_t>> blocks;
+    if ( n < 6u )
+    {
+      words[0] = tt_small( f, 0u, small_tables );
+    }
+    else
+    {
+      tt_fill( f, 0u, words, small_tables, blocks );
+    }
+
+    std::vector<var_t> var_at_bit( n );
+    for ( auto j = 0u; j < n; ++j )
+    {
+      var_at_bit[j] = level2var[n - 1u - j];
+    }
+    for ( auto j = 0u; j < n; ++j )
+    {
+      while ( var_at_bit[j] != j )
+      {
+        var_t const v = var_at_bit[j];
+        Truth_Table::swap_vars( words, n, j, v );
+        std::swap( var_at_bit[j], var_at_bit[v] );
+      }
+    }
+  }
+
+  /* Whether `f` is dead (having a reference count of 0). */
+  bool is_dead( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    return nodes[f >> 1].ref == 0;
+  }
+
+  /* Get the number of living nodes in the whole package, excluding constants. */
+  uint64_t num_nodes() const
+  {
+    uint64_t n = 0u;
+    for ( index_t i = 1u; i < nodes.size(); ++i )
+    {
+      if ( !is_dead( i << 1 ) )
+      {
+        ++n;
+      }
+    }
+    return n;
+  }
+
+  /* Get the number of nodes in the sub-graph rooted at node f, excluding constants. */
+  uint64_t num_nodes( index_t f ) const
+  {
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+
+    if ( f == constant( false ) || f == constant( true ) )
+    {
+      return 0u;
     }
 
     std::vector<bool> visited( nodes.size(), false );
     visited[0] = true;
-    visited[1] = true;
+    visited[f >> 1] = true;
+
+    uint64_t n = 0u;
+    std::vector<index_t> stack( 1u, f >> 1 );
+    while ( !stack.empty() )
+    {
+      Node const& F = nodes[stack.back()];
+      stack.pop_back();
+      ++n;
+      assert( ( F.T >> 1 ) < nodes.size() && "Make sure the children exist." );
+      assert( ( F.E >> 1 ) < nodes.size() && "Make sure the children exist." );
+      for ( auto const child : {F.T >> 1, F.E >> 1} )
+      {
+        if ( !visited[child] )
+        {
+          visited[child] = true;
+          stack.emplace_back( child );
+        }
+      }
+    }
+    return n;
+  }
+
+  uint64_t num_invoke() const
+  {
+    return num_invoke_not + num_invoke_and + num_invoke_or + num_invoke_xor + num_invoke_ite + num_invoke_and_exists + num_invoke_compose +
+           num_invoke_constrain + num_invoke_restrict + num_invoke_zdd + num_invoke_add + num_invoke_isop;
+  }
+
+  /* Number of dead nodes not yet garbage collected. */
+  uint64_t num_dead_nodes() const
+  {
+    return num_dead;
+  }
+
+  /* Number of garbage collections run so far. */
+  uint64_t num_garbage_collections() const
+  {
+    return num_gc;
+  }
+
+  /* Number of nodes created in a slot freed by garbage collection. */
+  uint64_t num_recycled_nodes() const
+  {
+    return num_recycled;
+  }
+
+  /* Average number of nodes per bucket in the unique table of `var`. */
+  double unique_table_load_factor( var_t var ) const
+  {
+    assert( var < num_vars() && "Variables range from 0 to `num_vars - 1`." );
+    return double( unique_table[var].num_entries ) / unique_table[var].buckets.size();
+  }
+
+  /* Average number of nodes per bucket in the unique tables of all variables. */
+  double unique_table_load_factor() const
+  {
+    uint64_t entries = 0u, buckets = 0u;
+    for ( auto const& table : unique_table )
+    {
+      entries += table.num_entries;
+      buckets += table.buckets.size();
+    }
+    return double( entries ) / buckets;
+  }
+
+  /* Average number of nodes visited per unique table lookup. */
+  double unique_table_probes_per_lookup() const
+  {
+    return num_unique_lookup == 0u ? 0.0 : double( num_unique_probe ) / num_unique_lookup;
+  }
+
+  /* Number of living nodes, excluding constants. Unlike `num_nodes()`, this takes constant time. */
+  uint64_t num_live_nodes() const
+  {
+    return nodes.size() - 1u - free_list.size() - num_dead;
+  }
+
+  /* Largest number of nodes (living or dead) stored at once so far, excluding constants: freed slots
+   * are recycled before new ones are allocated, so this is the number of allocated slots
+   * (including the ones reserved by the parallel operations). */
+  uint64_t peak_num_nodes() const
+  {
+    return nodes.size() - 1u;
+  }
+
+  /* Number of calls of `minimize` so far. */
+  uint64_t num_minimize_calls() const
+  {
+    return num_minimize;
+  }
+
+  /* Total sizes (in nodes) of the operands and of the results of the calls of `minimize` so far. */
+  std::pair<uint64_t, uint64_t> num_minimized_nodes() const
+  {
+    return std::make_pair( minimize_nodes_before, minimize_nodes_after );
+  }
+
+  /* Number of (sifting or window) reorderings run so far. */
+  uint64_t num_reorderings() const
+  {
+    return num_reorder;
+  }
+
+  /* Number of adjacent level swaps performed so far. */
+  uint64_t num_swaps() const
+  {
+    return num_swap;
+  }
+
+  /* Number of computed table lookups that found the requested entry. */
+  uint64_t num_cache_hits() const
+  {
+    return num_cache_hit;
+  }
+
+  /* Number of computed table lookups that did not find the requested entry. */
+  uint64_t num_cache_misses() const
+  {
+    return num_cache_miss;
+  }
+
+  /* Number of computed table insertions that overwrote a different valid entry. */
+  uint64_t num_cache_evictions() const
+  {
+    return num_cache_eviction;
+  }
+
+  /* Number of entries in the computed table. */
+  uint64_t cache_size() const
+  {
+    return computed_table.size();
+  }
+
+  /* Resize (and clear) the computed table. `size` is rounded up to a power of two. */
+  void resize_cache( uint32_t size )
+  {
+    uint32_t capacity = 1u;
+    while ( capacity < size && capacity < ( 1u << 31 ) )
+    {
+      capacity <<= 1;
+    }
+    computed_table.assign( capacity, Cache_Entry( {OP_NONE, 0, 0, 0, 0, 0} ) );
+  }
+
+  /* Limit the memory of the manager to `max_nodes` node slots (excluding constants) and roughly
+   * `max_bytes` bytes (see `memory_usage`). When an operation runs out of budget, the dead nodes
+   * are collected (and the computed table is halved, down to 1024 entries, if over the byte limit)
+   * and the operation is restarted; if it still does not fit, it throws `Memory_Limit_Exceeded`.
+   * Only the operations and `load` are limited, not `literal`, `from_tt` or reordering. */
+  void set_memory_limit( uint64_t max_nodes, uint64_t max_bytes = std::numeric_limits<uint64_t>::max() )
+  {
+    this->max_nodes = max_nodes;
+    this->max_bytes = max_bytes;
+  }
+
+  /* Number of bytes allocated by the node store, the unique tables and the computed table. */
+  uint64_t memory_usage() const
+  {
+    uint64_t bytes = nodes.memory() + free_list.capacity() * sizeof( index_t ) + apply_stack.capacity() * sizeof( Apply_Frame ) +
+                     compute_stack.capacity() * sizeof( Compute_Frame ) + computed_table.size() * sizeof( Cache_Entry );
+    for ( auto const& table : unique_table )
+    {
+      bytes += table.buckets.size() * sizeof( index_t );
+    }
+    for ( auto const& table : zdd_table )
+    {
+      bytes += table.buckets.size() * sizeof( index_t );
+    }
+    for ( auto const& table : add_table )
+    {
+      bytes += table.buckets.size() * sizeof( index_t );
+    }
+    return bytes + add_values.capacity() * sizeof( double );
+  }
+
+  /* Number of operations abandoned because of the memory limit so far. */
+  uint64_t num_memory_aborts() const
+  {
+    return num_memory_abort;
+  }
+
+#ifdef BDD_INSTRUMENTATION
+  /**********************************************************/
+  /********************* Instrumentation ********************/
+  /**********************************************************/
+  /* Detailed statistics, recorded only if `BDD_INSTRUMENTATION` is defined. The unique table
+   * statistics per level only cover the single-threaded operations. */
+  struct Instrumentation
+  {
+    static const uint32_t num_latency_buckets = 40u;
+
+    std::chrono::steady_clock::time_point start; /* creation of the manager */
+    std::vector<uint64_t> unique_lookups, unique_probes, unique_collisions; /* per level; a collision is a probe of another node */
+    std::vector<uint64_t> diagram_lookups, diagram_probes, diagram_collisions; /* the same for the ZDD and ADD nodes, per variable */
+    uint64_t cache_hits[NUM_OPS], cache_misses[NUM_OPS]; /* per operation code */
+    uint64_t allocated_nodes; /* nodes created so far */
+    uint64_t peak_live_nodes;
+    uint64_t num_gc;
+    double gc_seconds, max_gc_seconds; /* total and longest pause */
+    /* Latencies of the calls of the operations, per operation code: bucket `b` counts the calls
+     * taking from 2^b to 2^(b+1) - 1 nanoseconds (the last one, longer calls too). */
+    uint64_t latencies[NUM_OPS][num_latency_buckets];
+
+    /* Nodes created per second since the creation of the manager. */
+    double allocation_rate() const
+    {
+      double const seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      return seconds > 0.0 ? allocated_nodes / seconds : 0.0;
+    }
+  };
+
+  Instrumentation const& instrumentation() const
+  {
+    return instr;
+  }
+
+  /* Name of the operation code `op` (an index of the arrays of `Instrumentation`). */
+  static char const* op_name( uint32_t op )
+  {
+    static char const* const names[] = {"none", "and", "or", "xor", "ite", "and_exists", "compose", "vector_compose", "constrain", "restrict",
+                                          "zdd_union", "zdd_intersection", "zdd_difference", "zdd_change", "zdd_subset0",
+                                          "zdd_subset1", "zdd_product", "zdd_divide", "zdd_from_bdd", "zdd_to_bdd",
+                                          "add_plus", "add_times", "add_min", "add_max", "add_threshold", "add_sum_abstract",
+                                          "add_max_abstract", "add_from_bdd", "add_to_bdd", "isop"};
+    static_assert( sizeof( names ) / sizeof( names[0] ) == NUM_OPS, "Name every operation." );
+    return names[op];
+  }
+
+  /* Print the instrumentation to `os`. */
+  void dump_instrumentation( std::ostream& os ) const
+  {
+    os << "allocated nodes: " << instr.allocated_nodes << " (" << instr.allocation_rate() << " per second), peak live nodes: "
+       << instr.peak_live_nodes << ", live nodes: " << num_live_nodes() << std::endl;
+    os << "garbage collections: " << instr.num_gc << ", " << instr.gc_seconds << " s in total, longest " << instr.max_gc_seconds << " s" << std::endl;
+    for ( uint32_t op = OP_NONE + 1u; op < NUM_OPS; ++op )
+    {
+      uint64_t calls = 0u;
+      for ( auto const count : instr.latencies[op] )
+      {
+        calls += count;
+      }
+      if ( calls + instr.cache_hits[op] + instr.cache_misses[op] == 0u )
+      {
+        continue;
+      }
+      os << op_name( op ) << ": " << calls << " calls, cache " << instr.cache_hits[op] << " hits / " << instr.cache_misses[op] << " misses, latency";
+      for ( auto b = 0u; b < Instrumentation::num_latency_buckets; ++b )
+      {
+        if ( instr.latencies[op][b] != 0u )
+        {
+          os << " [2^" << b << " ns] " << instr.latencies[op][b];
+        }
+      }
+      os << std::endl;
+    }
+    for ( auto l = 0u; l < num_vars(); ++l )
+    {
+      if ( instr.unique_lookups[l] != 0u )
+      {
+        os << "level " << l << ": " << instr.unique_lookups[l] << " lookups, " << instr.unique_probes[l] << " probes, "
+           << instr.unique_collisions[l] << " collisions" << std::endl;
+      }
+    }
+    for ( auto v = 0u; v < num_vars(); ++v )
+    {
+      if ( instr.diagram_lookups[v] != 0u )
+      {
+        os << "ZDD/ADD variable " << v << ": " << instr.diagram_lookups[v] << " lookups, " << instr.diagram_probes[v] << " probes, "
+           << instr.diagram_collisions[v] << " collisions" << std::endl;
+      }
+    }
+  }
+
+  /* Dump the instrumentation to `*os` at the beginning of the operations, at most once every
+   * `period` seconds (never if `os` is null). */
+  void set_instrumentation_dump( std::ostream* os, double period )
+  {
+    dump_stream = os;
+    dump_period = period;
+    last_dump = std::chrono::steady_clock::now();
+  }
+#endif
+
+private:
+  /**********************************************************/
+  /********************** Apply Engine **********************/
+  /**********************************************************/
+  /* Intermediate results of the engine are not referenced,
+   * so garbage collection must not happen while it runs. */
+
+  /* Operator tags of `apply`. Each one provides the operation code keying the computed table,
+   * whether it uses its third operand, whether its third operand is a cube of variables to quantify,
+   * its invocation counter and `reduce`, which normalizes the operands (moving a complement
+   * of the result to `c`) and returns true, setting `r`, if the result is trivial. */
+  struct And_Op
+  {
+    static uint32_t code() { return OP_AND; }
+    static const bool ternary = false;
+    static const bool quantifying = false;
+    static uint64_t& invocations( Basic_BDD& m ) { return m.num_invoke_and; }
+    static bool reduce( index_t& f, index_t& g, index_t&, index_t&, index_t& r )
+    {
+      if ( f == constant( false ) || g == constant( false ) || f == ( g ^ 1 ) )
+      {
+        r = constant( false );
+        return true;
+      }
+      if ( f == constant( true ) || f == g )
+      {
+        r = g;
+        return true;
+      }
+      if ( g == constant( true ) )
+      {
+        r = f;
+        return true;
+      }
+      /* The operation is commutative: normalize the operand order so that `AND( f, g )`
+       * and `AND( g, f )` share one computed table entry. */
+      if ( f > g )
+      {
+        std::swap( f, g );
+      }
+      return false;
+    }
+  };
+
+  struct Or_Op
+  {
+    static uint32_t code() { return OP_OR; }
+    static const bool ternary = false;
+    static const bool quantifying = false;
+    static uint64_t& invocations( Basic_BDD& m ) { return m.num_invoke_or; }
+    static bool reduce( index_t& f, index_t& g, index_t&, index_t&, index_t& r )
+    {
+      if ( f == constant( true ) || g == constant( true ) || f == ( g ^ 1 ) )
+      {
+        r = constant( true );
+        return true;
+      }
+      if ( f == constant( false ) || f == g )
+      {
+        r = g;
+        return true;
+      }
+      if ( g == constant( false ) )
+      {
+        r = f;
+        return true;
+      }
+      if ( f > g )
+      {
+        std::swap( f, g );
+      }
+      return false;
+    }
+  };
+
+  struct Xor_Op
+  {
+    static uint32_t code() { return OP_XOR; }
+    static const bool ternary = false;
+    static const bool quantifying = false;
+    static uint64_t& invocations( Basic_BDD& m ) { return m.num_invoke_xor; }
+    static bool reduce( index_t& f, index_t& g, index_t&, index_t& c, index_t& r )
+    {
+      /* Complements can be pulled out of both operands: ~f ^ g = f ^ ~g = ~( f ^ g ). */
+      c = ( f ^ g ) & 1;
+      f = regular( f );
+      g = regular( g );
+      if ( f == g )
+      {
+        r = constant( false ) ^ c;
+        return true;
+      }
+      if ( f == constant( true ) )
+      {
+        r = g ^ c ^ 1;
+        return true;
+      }
+      if ( g == constant( true ) )
+      {
+        r = f ^ c ^ 1;
+        return true;
+      }
+      if ( f > g )
+      {
+        std::swap( f, g );
+      }
+      return false;
+    }
+  };
+
+  struct Ite_Op
+  {
+    static uint32_t code() { return OP_ITE; }
+    static const bool ternary = true;
+    static const bool quantifying = false;
+    static uint64_t& invocations( Basic_BDD& m ) { return m.num_invoke_ite; }
+    static bool reduce( index_t& f, index_t& g, index_t& h, index_t& c, index_t& r )
+    {
+      if ( f == constant( true ) || g == h )
+      {
+        r = g;
+        return true;
+      }
+      if ( f == constant( false ) )
+      {
+        r = h;
+        return true;
+      }
+
+      /* ITE(~f, g, h) = ITE(f, h, g) */
+      if ( is_complemented( f ) )
+      {
+        f ^= 1;
+        std::swap( g, h );
+      }
+
+      /* standard triples: ITE(f, f, h) = ITE(f, 1, h), ITE(f, ~f, h) = ITE(f, 0, h),
+       * ITE(f, g, f) = ITE(f, g, 0) and ITE(f, g, ~f) = ITE(f, g, 1) */
+      if ( regular( g ) == f )
+      {
+        g = constant( !is_complemented( g ) );
+      }
+      if ( regular( h ) == f )
+      {
+        h = constant( is_complemented( h ) );
+      }
+      if ( g == constant( true ) && h == constant( false ) )
+      {
+        r = f;
+        return true;
+      }
+      if ( g == constant( false ) && h == constant( true ) )
+      {
+        r = f ^ 1;
+        return true;
+      }
+
+      /* ITE(f, ~g, h) = ~ITE(f, g, ~h): keep the THEN operand regular. */
+      c = g & 1;
+      g ^= c;
+      h ^= c;
+      return false;
+    }
+  };
+
+  /* \exists h. ( f & g ), where `h` is a cube. Once the variables of `h` above the top variable
+   * of `f` and `g` are dropped, the call quantifies that variable if it is the top one of `h`,
+   * by disjoining the results of the cofactors; if `h` becomes empty, it is just an AND. */
+  struct And_Exists_Op
+  {
+    static uint32_t code() { return OP_AND_EXISTS; }
+    static const bool ternary = false;
+    static const bool quantifying = true;
+    static uint64_t& invocations( Basic_BDD& m ) { return m.num_invoke_and_exists; }
+    static bool reduce( index_t& f, index_t& g, index_t&, index_t&, index_t& r )
+    {
+      if ( f == constant( false ) || g == constant( false ) || f == ( g ^ 1 ) )
+      {
+        r = constant( false );
+        return true;
+      }
+      /* f & f = 1 & f; normalize the operand order, which moves a constant 1 to `f`. */
+      if ( f == g )
+      {
+        f = constant( true );
+      }
+      if ( f > g )
+      {
+        std::swap( f, g );
+      }
+      if ( g == constant( true ) )
+      {
+        r = constant( true );
+        return true;
+      }
+      return false;
+    }
+  };
+
+  /* A pending call of `apply`, waiting for the results of its cofactors. */
+  struct Apply_Frame
+  {
+    index_t f, g, h; /* normalized operands */
+    index_t f1, g1, h1; /* positive cofactors of the operands */
+    index_t r0; /* result of the negative cofactors */
+    index_t c; /* complement of the result */
+    var_t x; /* top variable */
+    bool then_pending; /* whether the positive cofactors are still to be computed */
+    bool quantify; /* whether `x` is quantified (by quantifying operators) */
+  };
+
+  /* Per-thread state of the parallel operations. */
+  struct Worker_Context
+  {
+    std::vector<Apply_Frame> stack; /* pending calls of `apply` run by this thread */
+    std::vector<index_t> slots; /* free node slots reserved for this thread */
+    uint64_t invocations[NUM_OPS];
+    uint64_t cache_hit, cache_miss, cache_eviction;
+    uint64_t unique_lookup, unique_probe, new_nodes, recycled;
+  };
+
+  /* Compute `Op( f, g, h )` (binary operators ignore `h`, which should be 0).
+   * Instead of recursing on the cofactors, pending calls are kept on the explicit stack
+   * `apply_stack`, so the depth is only limited by memory. Calls may nest: a call only
+   * pops the frames it pushed.
+   *
+   * If `concurrent`, this is run by a task of a parallel operation: the stack and the
+   * statistics of the worker `w` are used instead, and so are the thread-safe versions of
+   * `unique` and of the computed table accessors. If the parallel operation is aborted,
+   * the call returns early with a meaningless result. */
+  template<typename Op, bool concurrent = false>
+  index_t apply( index_t f, index_t g, index_t h, Worker_Context* w = nullptr )
+  {
+    static_assert( !( concurrent && Op::quantifying ), "Quantifying operators are not parallelized." );
+    assert( ( f >> 1 ) < nodes.size() && "Make sure f exists." );
+    assert( ( g >> 1 ) < nodes.size() && "Make sure g exists." );
+    assert( ( h >> 1 ) < nodes.size() && "Make sure h exists." );
+
+    std::vector<Apply_Frame>& stack = concurrent ? w->stack : apply_stack;
+    std::size_t const base = stack.size();
+    index_t result;
+    while ( true )
+    {
+      /* Descend: start the call `Op( f, g, h )`. */
+      if ( concurrent && parallel_aborted.load( std::memory_order_relaxed ) )
+      {
+        stack.resize( base );
+        return constant( false );
+      }
+      ++( concurrent ? w->invocations[Op::code()] : Op::invocations( *this ) );
+      index_t c = 0;
+      if ( !Op::reduce( f, g, h, c, result ) )
+      {
+        if ( Op::quantifying )
+        {
+          /* Drop the variables of the cube `h` that `f` and `g` do not depend on. */
+          uint32_t const l = std::min( level( f ), level( g ) );
+          while ( level( h ) < l )
+          {
+            assert( get_node( h ).E == constant( false ) && "Make sure h is a cube of positive literals." );
+            h = get_node( h ).T;
+          }
+        }
+        if ( Op::quantifying && h == constant( true ) )
+        {
+          result = apply<And_Op>( f, g, 0 ) ^ c;
+        }
+        else if ( concurrent ? cache_lookup_concurrent( Op::code(), f, g, h, result, *w )
+                        : cache_lookup( Op::code(), f, g, h, result ) )
+        {
+          result ^= c;
+        }
+        else
+        {
+          /* Suspend the call and continue with the negative cofactors. */
+          stack.emplace_back();
+          Apply_Frame& frame = stack.back();
+          frame.f = f;
+          frame.g = g;
+          frame.h = h;
+          frame.c = c;
+          frame.x = Op::ternary ? top_var( f, g, h ) : top_var( f, g );
+          frame.then_pending = true;
+          frame.quantify = Op::quantifying && get_node( h ).v == frame.x;
+          cofactors( f, frame.x, f, frame.f1 );
+          cofactors( g, frame.x, g, frame.g1 );
+          frame.h1 = h;
+          if ( Op::ternary )
+          {
+            cofactors( h, frame.x, h, frame.h1 );
+          }
+          if ( frame.quantify )
+          {
+            h = frame.h1 = get_node( h ).T;
+          }
+          continue;
+        }
+      }
+
+      /* Ascend: pass `result` to the suspended calls, finishing the ones having both cofactors. */
+      while ( true )
+      {
+        if ( stack.size() == base )
+        {
+          return result;
+        }
+        Apply_Frame& frame = stack.back();
+        if ( frame.then_pending && !( frame.quantify && result == constant( true ) ) )
+        {
+          frame.r0 = result;
+          frame.then_pending = false;
+          f = frame.f1;
+          g = frame.g1;
+          h = frame.h1;
+          break;
+        }
+        index_t r;
+        if ( concurrent )
+        {
+          if ( !unique_concurrent( frame.x, result, frame.r0, r, *w ) )
+          {
+            stack.resize( base );
+            return constant( false );
+          }
+          cache_insert_concurrent( Op::code(), frame.f, frame.g, frame.h, r, *w );
+        }
+        else if ( frame.quantify )
+        {
+          /* The disjunction is 1 if the negative cofactors gave 1 (and the positive ones were skipped). */
+          Apply_Frame const done = frame;
+          stack.pop_back();
+          r = done.then_pending ? constant( true ) : apply<Or_Op>( result, done.r0, 0 );
+          cache_insert( Op::code(), done.f, done.g, done.h, r );
+          result = r ^ done.c;
+          continue;
+        }
+        else
+        {
+          r = unique( frame.x, result, frame.r0 );
+          cache_insert( Op::code(), frame.f, frame.g, frame.h, r );
+        }
+        result = r ^ frame.c;
+        stack.pop_back();
+      }
+    }
+  }
+
+  /* Compute `Op( f, g, h )` with the thread pool.
+   * The node slots the threads may fill are reserved beforehand, so that `nodes` is not
+   * reallocated meanwhile. If they run out, the operation is aborted and restarted with
+   * twice as many; the nodes and computed table entries built so far are reused. */
+  template<typename Op>
+  index_t parallel_apply( index_t f, index_t g, index_t h )
+  {
+    uint64_t reserve = std::max<uint64_t>( 1u << 16, num_live_nodes() );
+    while ( true )
+    {
+      /* Never reserve slots beyond the memory limit. */
+      bool const capped = limit_active && nodes.size() - 1u + reserve - std::min<uint64_t>( reserve, free_list.size() ) > max_nodes;
+      if ( capped )
+      {
+        reserve = free_list.size() + ( max_nodes + 1u - std::min<uint64_t>( max_nodes + 1u, nodes.size() ) );
+      }
+      if ( free_list.size() < reserve )
+      {
+        index_t const first = nodes.size();
+        nodes.resize( first + reserve - free_list.size(), Node( {0, 0, 0, free_var(), 0} ) );
+        for ( index_t n = nodes.size(); n-- > first; )
+        {
+          free_list.emplace_back( n );
+        }
+      }
+
+      index_t result = 0;
+      parallel_aborted.store( false );
+      pool->run( [&]() { result = parallel_apply_rec<Op>( f, g, h, 0u ); } );
+
+      /* Give back the unused slots and merge the statistics. */
+      for ( auto& w : workers )
+      {
+        free_list.insert( free_list.end(), w.slots.begin(), w.slots.end() );
+        w.slots.clear();
+        num_invoke_and += w.invocations[OP_AND];
+        num_invoke_or += w.invocations[OP_OR];
+        num_invoke_xor += w.invocations[OP_XOR];
+        num_invoke_ite += w.invocations[OP_ITE];
+        num_cache_hit += w.cache_hit;
+        num_cache_miss += w.cache_miss;
+        num_cache_eviction += w.cache_eviction;
+        num_unique_lookup += w.unique_lookup;
+        num_unique_probe += w.unique_probe;
+        num_dead += w.new_nodes;
+        num_recycled += w.recycled;
+        BDD_INSTRUMENT( instr.cache_hits[Op::code()] += w.cache_hit; instr.cache_misses[Op::code()] += w.cache_miss;
+                        instr.allocated_nodes += w.new_nodes; )
+        std::vector<Apply_Frame> stack;
+        stack.swap( w.stack );
+        w = Worker_Context();
+        w.stack.swap( stack );
+      }
+
+      /* The unique tables could not grow during the operation. */
+      for ( auto& table : unique_table )
+      {
+        uint64_t buckets = table.buckets.size();
+        while ( buckets < table.num_entries )
+        {
+          buckets <<= 1;
+        }
+        if ( buckets != table.buckets.size() )
+        {
+          resize_subtable( table, buckets );
+        }
+      }
+
+      if ( !parallel_aborted.load() )
+      {
+        return result;
+      }
+      if ( capped )
+      {
+        throw Memory_Limit_Exceeded( "BDD memory limit exceeded" );
+      }
+      reserve <<= 1;
+    }
+  }
+
+  /* One call of a parallel operation at recursion depth `depth`: either spawns the computation
+   * of the positive cofactors as a task, or runs the sequential engine in the current thread. */
+  template<typename Op>
+  index_t parallel_apply_rec( index_t f, index_t g, index_t h, uint32_t depth )
+  {
+    Worker_Context& w = workers[pool->worker_id()];
+    if ( depth >= max_spawn_depth || parallel_aborted.load( std::memory_order_relaxed ) )
+    {
+      return apply<Op, true>( f, g, h, &w );
+    }
+
+    ++w.invocations[Op::code()];
+    index_t c = 0, r;
+    if ( Op::reduce( f, g, h, c, r ) )
+    {
+      return r;
+    }
+    if ( cache_lookup_concurrent( Op::code(), f, g, h, r, w ) )
+    {
+      return r ^ c;
+    }
+
+    var_t const x = Op::ternary ? top_var( f, g, h ) : top_var( f, g );
+    index_t f0, f1, g0, g1, h0, h1;
+    cofactors( f, x, f0, f1 );
+    cofactors( g, x, g0, g1 );
+    cofactors( h, x, h0, h1 );
+
+    index_t r1 = 0;
+    Work_Stealing_Pool::Task task;
+    pool->spawn( task, [&]() { r1 = parallel_apply_rec<Op>( f1, g1, h1, depth + 1u ); } );
+    index_t const r0 = parallel_apply_rec<Op>( f0, g0, h0, depth + 1u );
+    pool->sync( task );
+
+    if ( parallel_aborted.load() || !unique_concurrent( x, r1, r0, r, w ) )
+    {
+      return constant( false );
+    }
+    cache_insert_concurrent( Op::code(), f, g, h, r, w );
+    return r ^ c;
+  }
+
+  /* A pending call of `compute`, waiting for the results of its sub-calls. */
+  struct Compute_Frame
+  {
+    index_t f, g, h; /* normalized operands */
+    index_t t[4]; /* results of the sub-calls, or other state of the operator */
+    index_t c; /* complement of the result */
+    var_t x; /* top variable */
+    uint32_t step; /* number of sub-calls returned so far */
+  };
+
+  /* Compute `op( f, g, h )` for the operators whose calls do more than combining the results on
+   * the cofactors with `unique`. Like `apply`, pending calls are kept on the explicit stack
+   * `compute_stack` instead of recursing, and calls may nest. The operator object provides:
+   * - `code()`: the operation memoized in the computed table, or `OP_NONE` not to memoize;
+   * - `invocations()`: the counter of calls;
+   * - `reduce( f, g, h, c, r )`: the terminal cases, as for `apply`, which may normalize the
+   *   operands, pulling the complement `c` out of the result;
+   * - `step( frame, r, f, g, h )`: resumes the suspended call `frame` once `frame.step` of its
+   *   sub-calls have returned, the last one giving `r` (meaningless when `frame.step` is 0).
+   *   Returns true and sets `f`, `g` and `h` to make the next sub-call, or false and sets `r`
+   *   to the result. It may change `frame.step` to skip sub-calls. */
+  template<typename Op>
+  index_t compute( Op const& op, index_t f, index_t g, index_t h )
+  {
+    std::size_t const base = compute_stack.size();
+    index_t r = 0;
+    while ( true )
+    {
+      /* Descend: start the call `op( f, g, h )`. */
+      ++op.invocations();
+      index_t c = 0;
+      bool suspended = false;
+      Compute_Frame frame;
+      if ( !op.reduce( f, g, h, c, r ) )
+      {
+        if ( op.code() != OP_NONE && cache_lookup( op.code(), f, g, h, r ) )
+        {
+          r ^= c;
+        }
+        else
+        {
+          frame = Compute_Frame( {f, g, h, {0, 0, 0, 0}, c, 0, 0u} );
+          suspended = true;
+        }
+      }
+
+      /* Ascend: resume the suspended calls with `r`, until one makes a sub-call. The frame is
+       * off the stack meanwhile, as the operator may nest `compute`. */
+      while ( true )
+      {
+        if ( !suspended )
+        {
+          if ( compute_stack.size() == base )
+          {
+            return r;
+          }
+          frame = compute_stack.back();
+          compute_stack.pop_back();
+          ++frame.step;
+        }
+        if ( op.step( frame, r, f, g, h ) )
+        {
+          compute_stack.emplace_back( frame );
+          break;
+        }
+        if ( op.code() != OP_NONE )
+        {
+          cache_insert( op.code(), frame.f, frame.g, frame.h, r );
+        }
+        r ^= frame.c;
+        suspended = false;
+      }
+    }
+  }
+
+  /* Substitutes `substitution( v )` for every variable `v` of `f` down to level `last_level`.
+   * The results are memoized in the computed table as `op( f, g, h )`, where `g` and `h`
+   * identify the substitution. The ITEs combining the substituted cofactors nest `apply`. */
+  template<typename Substitution>
+  struct Compose_Op
+  {
+    Basic_BDD& m;
+    Substitution const& substitution;
+    uint32_t last_level;
+    uint32_t op;
+
+    uint32_t code() const { return op; }
+    uint64_t& invocations() const { return m.num_invoke_compose; }
+
+    bool reduce( index_t& f, index_t, index_t, index_t& c, index_t& r ) const
+    {
+      if ( m.level( f ) > last_level )
+      {
+        r = f;
+        return true;
+      }
+      c = f & 1;
+      f = regular( f );
+      return false;
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t& g, index_t& h ) const
+    {
+      Node const& F = m.get_node( frame.f );
+      g = frame.g;
+      h = frame.h;
+      switch ( frame.step )
+      {
+      case 0u:
+        f = F.T;
+        return true;
+      case 1u:
+        frame.t[0] = r;
+        f = F.E;
+        return true;
+      default:
+        r = m.apply<Ite_Op>( substitution( F.v ), frame.t[0], r );
+        return false;
+      }
+    }
+  };
+
+  /* Computes `constrain( f, g )`, or `restrict( f, g )` if `restricting`, `g` being the care set.
+   * Complements are pulled out of `f`: ~f|g = ~( f|g ). */
+  struct Generalized_Cofactor_Op
+  {
+    Basic_BDD& m;
+    bool restricting;
+
+    uint32_t code() const { return restricting ? OP_RESTRICT : OP_CONSTRAIN; }
+    uint64_t& invocations() const { return restricting ? m.num_invoke_restrict : m.num_invoke_constrain; }
+
+    bool reduce( index_t& f, index_t g, index_t, index_t& c, index_t& r ) const
+    {
+      if ( generalized_cofactor_terminal( f, g, r ) )
+      {
+        return true;
+      }
+      c = f & 1;
+      f = regular( f );
+      return false;
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t& g, index_t& h ) const
+    {
+      index_t f0, f1, g0, g1;
+      h = 0;
+      switch ( frame.step )
+      {
+      case 0u:
+        if ( restricting && m.level( frame.g ) < m.level( frame.f ) )
+        {
+          /* `f` does not depend on the top variable of `g`: quantify it. */
+          m.cofactors( frame.g, m.get_node( frame.g ).v, g0, g1 );
+          f = frame.f;
+          g = m.apply<Or_Op>( g0, g1, 0 );
+          frame.step = 2u;
+          return true;
+        }
+        frame.x = restricting ? m.get_node( frame.f ).v : m.top_var( frame.f, frame.g );
+        m.cofactors( frame.f, frame.x, f0, f1 );
+        m.cofactors( frame.g, frame.x, g0, g1 );
+        /* Outside of `g`, the cofactors of `f` are mapped to the other branch. */
+        if ( g1 == constant( false ) || g0 == constant( false ) )
+        {
+          f = g1 == constant( false ) ? f0 : f1;
+          g = g1 == constant( false ) ? g0 : g1;
+          frame.step = 2u;
+          return true;
+        }
+        f = f1;
+        g = g1;
+        return true;
+      case 1u:
+        frame.t[0] = r;
+        m.cofactors( frame.f, frame.x, f, f1 );
+        m.cofactors( frame.g, frame.x, g, g1 );
+        return true;
+      case 2u:
+        r = m.unique( frame.x, frame.t[0], r );
+        return false;
+      default: /* the single sub-call gave the result */
+        return false;
+      }
+    }
+  };
+
+  /**********************************************************/
+  /******************** Helper Functions ********************/
+  /**********************************************************/
+
+  /* The body of `vector_compose`. */
+  index_t vector_compose_rec( index_t f, std::vector<index_t> const& substitution )
+  {
+    /* Below the deepest substituted variable, nothing changes. */
+    uint32_t last_level = 0u;
+    for ( var_t v = 0u; v < num_vars(); ++v )
+    {
+      if ( substitution[v] != literal( v ) )
+      {
+        last_level = std::max( last_level, var2level[v] + 1u );
+      }
+    }
+    if ( last_level == 0u )
+    {
+      return f;
+    }
+
+    /* Every call gets a new identifier, as the substitution itself cannot key the computed table. */
+    if ( ++composition_id == 0u )
+    {
+      clear_cache();
+      composition_id = 1u;
+    }
+    return substitute( f, [&]( var_t v ) { return substitution[v]; }, last_level - 1u, OP_VECTOR_COMPOSE, composition_id, 0u );
+  }
+
+  /* Substitute `substitution( v )` for every variable `v` of `f` down to level `last_level` (see `Compose_Op`). */
+  template<typename Substitution>
+  index_t substitute( index_t f, Substitution const& substitution, uint32_t last_level, uint32_t op, index_t g, index_t h )
+  {
+    return compute( Compose_Op<Substitution>( {*this, substitution, last_level, op} ), f, g, h );
+  }
+
+  /* The terminal cases of `constrain` and `restrict`. Returns true, setting `r`, if the result is trivial. */
+  static bool generalized_cofactor_terminal( index_t f, index_t c, index_t& r )
+  {
+    if ( c == constant( true ) || regular( f ) == constant( true ) )
+    {
+      r = f;
+      return true;
+    }
+    if ( f == c )
+    {
+      r = constant( true );
+      return true;
+    }
+    if ( f == ( c ^ 1 ) )
+    {
+      r = constant( false );
+      return true;
+    }
+    return false;
+  }
+
+  /* Whether the computed table entry `entry` mentions a node slot freed by garbage collection.
+   * The operands of `OP_VECTOR_COMPOSE` after `f` are not edges (see `vector_compose`). */
+  bool is_stale( Cache_Entry const& entry ) const
+  {
+    /* The other operands of these operations are not edges. */
+    bool const edges = entry.op != OP_VECTOR_COMPOSE && entry.op != OP_ZDD_CHANGE && entry.op != OP_ZDD_SUBSET0 && entry.op != OP_ZDD_SUBSET1;
+    return is_free( entry.f >> 1 ) || is_free( entry.r >> 1 ) || ( edges && ( is_free( entry.g >> 1 ) || is_free( entry.h >> 1 ) ) );
+  }
+
+  /* Marker stored in the variable field of a freed node slot. */
+  static var_t free_var()
+  {
+    return ~var_t( 0 );
+  }
+
+  /* Add a reference to node `n` (not an edge). Returns whether it was dead.
+   * A count reaching its maximum sticks there, as in CUDD: a shared node of a `BDD64` may have more
+   * than 2^32 living parents, and the node then stays alive rather than being freed while in use. */
+  bool add_ref( index_t n )
+  {
+    uint32_t& ref = nodes[n].ref;
+    if ( ref == std::numeric_limits<uint32_t>::max() )
+    {
+      return false;
+    }
+    return ref++ == 0u;
+  }
+
+  /* Drop a reference to node `n` (not an edge). Returns whether it dies. Saturated counts stay. */
+  bool drop_ref( index_t n )
+  {
+    uint32_t& ref = nodes[n].ref;
+    if ( ref == std::numeric_limits<uint32_t>::max() )
+    {
+      return false;
+    }
+    return --ref == 0u;
+  }
+
+  /* Whether the node slot `n` (a node index, not an edge) is on the free list. */
+  bool is_free( index_t n ) const
+  {
+    return nodes[n].v == free_var();
+  }
+
+  /* Called at the beginning of every operation, when no unreferenced intermediate result exists:
+   * runs `garbage_collect` if the threshold set by `set_gc_threshold` is reached and `reorder`
+   * if automatic reordering is enabled and due. The operands are protected meanwhile. */
+  void before_operation( index_t f, index_t g, index_t h = 0 )
+  {
+    BDD_INSTRUMENT( dump_if_due(); )
+    bool const gc = num_dead >= gc_min_dead && num_dead >= gc_dead_ratio * ( nodes.size() - free_list.size() );
+    bool const reordering = auto_reorder && num_live_nodes() >= next_reorder;
+    if ( !gc && !reordering )
+    {
+      return;
+    }
+    ref( f );
+    ref( g );
+    ref( h );
+    if ( reordering )
+    {
+      reorder();
+    }
+    else
+    {
+      garbage_collect();
+    }
+    deref( f );
+    deref( g );
+    deref( h );
+  }
+
+  /* Run `operation`, the body of an operation with operands `f`, `g` and `h`, within the memory
+   * limit. If it runs out of budget, the partial result is garbage collected (and the computed table
+   * shrunk, if the byte limit is hit) and it is restarted, reusing the cached results that survived. */
+  template<typename Operation>
+  index_t run_operation( index_t f, index_t g, index_t h, Operation const& operation )
+  {
+    before_operation( f, g, h );
+    bool collected = false;
+    while ( true )
+    {
+      try
+      {
+        Operation_Scope const scope( *this );
+        return operation();
+      }
+      catch ( Memory_Limit_Exceeded const& )
+      {
+        bool const shrink = byte_limit_hit && computed_table.size() > ( 1u << 10 );
+        if ( collected && !shrink )
+        {
+          ++num_memory_abort;
+          throw;
+        }
+        ref( f );
+        ref( g );
+        ref( h );
+        if ( shrink )
+        {
+          resize_cache( computed_table.size() >> 1 );
+        }
+        garbage_collect();
+        deref( f );
+        deref( g );
+        deref( h );
+        collected = true;
+      }
+    }
+  }
+
+  /* Puts the operation bodies under the memory limit (see `run_operation`) for its lifetime. However
+   * the body exits, even by an exception other than `Memory_Limit_Exceeded` (e.g., `std::bad_alloc`),
+   * the limit is lifted again and the pending calls the body left on the stacks of `apply` and `compute` are dropped. */
+  struct Operation_Scope
+  {
+    explicit Operation_Scope( Basic_BDD& m )
+        : m( m ), was_active( m.limit_active ), apply_depth( m.apply_stack.size() ), compute_depth( m.compute_stack.size() )
+    {
+      m.limit_active = true;
+    }
+
+    ~Operation_Scope()
+    {
+      m.limit_active = was_active;
+      m.apply_stack.resize( apply_depth );
+      m.compute_stack.resize( compute_depth );
+    }
+
+    Basic_BDD& m;
+    bool was_active;
+    std::size_t apply_depth, compute_depth;
+  };
+
+  /* Called by `unique` before allocating a new node slot: throws `Memory_Limit_Exceeded` if it would
+   * exceed the memory limit during an operation. The bytes are only recounted every 1024 slots,
+   * and never without a byte limit, as `memory_usage` visits the unique tables of all variables. */
+  void check_memory_limit()
+  {
+    if ( !limit_active )
+    {
+      return;
+    }
+    byte_limit_hit = max_bytes != std::numeric_limits<uint64_t>::max() && ( nodes.size() & 1023u ) == 0u && memory_usage() > max_bytes;
+    if ( nodes.size() > max_nodes || byte_limit_hit )
+    {
+      throw Memory_Limit_Exceeded( "BDD memory limit exceeded" );
+    }
+  }
+
+  /* Level of the top variable of edge `f` (`num_vars` for the constants). */
+  uint32_t level( index_t f ) const
+  {
+    return var2level[get_node( f ).v];
+  }
+
+  /* The top variable among the ones of `f` and `g`. */
+  var_t top_var( index_t f, index_t g ) const
+  {
+    return level( f ) <= level( g ) ? get_node( f ).v : get_node( g ).v;
+  }
+
+  /* The top variable among the ones of `f`, `g` and `h`. */
+  var_t top_var( index_t f, index_t g, index_t h ) const
+  {
+    var_t const x = top_var( f, g );
+    return var2level[x] <= level( h ) ? x : get_node( h ).v;
+  }
+
+  void clear_cache()
+  {
+    for ( auto& entry : computed_table )
+    {
+      entry.op = OP_NONE;
+    }
+  }
+
+  /* Remove the dead nodes from `table` and put their slots on the free list. */
+  void unlink_dead( Subtable& table )
+  {
+    for ( auto& head : table.buckets )
+    {
+      /* Unlink the dead nodes from the chain. */
+      index_t* link = &head;
+      while ( *link != 0 )
+      {
+        Node& N = nodes[*link];
+        if ( N.ref == 0 )
+        {
+          N.v = free_var();
+          free_list.emplace_back( *link );
+          --table.num_entries;
+          *link = N.next;
+        }
+        else
+        {
+          link = &N.next;
+        }
+      }
+    }
+  }
+
+  /* Insert node `n` (not an edge) into the unique table of its variable. */
+  void insert_node( index_t n )
+  {
+    Subtable& table = unique_table[nodes[n].v];
+    index_t& head = table.buckets[unique_hash( nodes[n].T, nodes[n].E ) & ( table.buckets.size() - 1u )];
+    nodes[n].next = head;
+    head = n;
+    if ( ++table.num_entries > table.buckets.size() )
+    {
+      resize_subtable( table, table.buckets.size() << 1 );
+    }
+  }
+
+  /* Remove node `n` (not an edge) from the unique table of its variable. */
+  void remove_node( index_t n )
+  {
+    Subtable& table = unique_table[nodes[n].v];
+    index_t* link = &table.buckets[unique_hash( nodes[n].T, nodes[n].E ) & ( table.buckets.size() - 1u )];
+    while ( *link != n )
+    {
+      assert( *link != 0 && "Make sure the node is in the unique table." );
+      link = &nodes[*link].next;
+    }
+    *link = nodes[n].next;
+    --table.num_entries;
+  }
+
+  /* Like `deref`, but a node reaching a reference count of 0 is freed immediately
+   * instead of becoming dead. Used during reordering, where no dead node may exist. */
+  void deref_and_free( index_t f )
+  {
+    if ( ( f >> 1 ) == 0 )
+    {
+      return;
+    }
+    assert( nodes[f >> 1].ref > 0 && "Make sure f was referenced before." );
+    if ( !drop_ref( f >> 1 ) )
+    {
+      return;
+    }
+
+    std::vector<index_t> stack( 1u, f >> 1 );
+    while ( !stack.empty() )
+    {
+      index_t const n = stack.back();
+      stack.pop_back();
+      remove_node( n );
+      nodes[n].v = free_var();
+      free_list.emplace_back( n );
+      for ( auto const child : {nodes[n].T >> 1, nodes[n].E >> 1} )
+      {
+        if ( child != 0 && drop_ref( child ) )
+        {
+          stack.emplace_back( child );
+        }
+      }
+    }
+  }
+
+  /* Exchange the variables at levels `l` and `l + 1` in place.
+   * Requires that there are no dead nodes and that the computed table is empty. */
+  void swap_adjacent( uint32_t l )
+  {
+    var_t const x = level2var[l];
+    var_t const y = level2var[l + 1u];
+    ++num_swap;
+
+    /* Take out the nodes of `x` having a child labeled with `y`. The other nodes of `x`
+     * do not depend on `y` and simply move one level down, as the nodes of `y` move up. */
+    std::vector<index_t> moved;
+    Subtable& table = unique_table[x];
+    for ( auto& head : table.buckets )
+    {
+      index_t* link = &head;
+      while ( *link != 0 )
+      {
+        Node& N = nodes[*link];
+        if ( get_node( N.T ).v == y || get_node( N.E ).v == y )
+        {
+          moved.emplace_back( *link );
+          --table.num_entries;
+          *link = N.next;
+        }
+        else
+        {
+          link = &N.next;
+        }
+      }
+    }
+
+    std::swap( var2level[x], var2level[y] );
+    std::swap( level2var[l], level2var[l + 1u] );
+
+    /* Rewrite every taken out node f = x ? ( y ? f11 : f10 ) : ( y ? f01 : f00 )
+     * into f = y ? ( x ? f11 : f01 ) : ( x ? f10 : f00 ), keeping its index. */
+    for ( auto const n : moved )
+    {
+      index_t const f1 = nodes[n].T, f0 = nodes[n].E;
+      index_t f10, f11, f00, f01;
+      cofactors( f1, y, f10, f11 );
+      cofactors( f0, y, f00, f01 );
+
+      index_t const T = ref( unique( x, f11, f01 ) );
+      index_t const E = ref( unique( x, f10, f00 ) );
+      assert( !is_complemented( T ) && "The THEN edge stays regular." );
+      nodes[n].v = y;
+      nodes[n].T = T;
+      nodes[n].E = E;
+      insert_node( n );
+
+      deref_and_free( f1 );
+      deref_and_free( f0 );
+    }
+  }
+
+  /* Move variable `v` through all levels and leave it at the one giving the fewest living nodes. */
+  void sift( var_t v )
+  {
+    uint64_t best_size = num_live_nodes();
+    uint32_t best_level = var2level[v];
+
+    /* Moves `v` one level down (or up) and keeps track of the best level.
+     * Returns false when the growth bound is exceeded. */
+    auto const step = [&]( bool down ) {
+      swap_adjacent( down ? var2level[v] : var2level[v] - 1u );
+      uint64_t const size = num_live_nodes();
+      if ( size < best_size )
+      {
+        best_size = size;
+        best_level = var2level[v];
+      }
+      return size <= max_growth * best_size;
+    };
+
+    /* Go to the closer end first. */
+    bool const down_first = 2u * var2level[v] >= num_vars();
+    for ( auto pass = 0u; pass < 2u; ++pass )
+    {
+      bool const down = ( pass == 0u ) == down_first;
+      while ( down ? var2level[v] + 1u < num_vars() : var2level[v] > 0u )
+      {
+        if ( !step( down ) )
+        {
+          break;
+        }
+      }
+    }
+
+    while ( var2level[v] > best_level )
+    {
+      swap_adjacent( var2level[v] - 1u );
+    }
+    while ( var2level[v] < best_level )
+    {
+      swap_adjacent( var2level[v] );
+    }
+  }
+
+  /* Number of buckets of a newly created unique table. */
+  static uint64_t initial_buckets()
+  {
+    return 64u;
+  }
+
+  /* Bucket of the node with children `T` and `E` (before masking with the table size). */
+  static uint64_t unique_hash( index_t T, index_t E )
+  {
+    /* The finalizer of MurmurHash3 spreads every input bit over the whole word,
+     * so the low bits used as the bucket index depend on both children. */
+    uint64_t key = uint64_t( T ) * 0x9e3779b97f4a7c15ull ^ E;
+    key ^= key >> 33;
+    key *= 0xff51afd7ed558ccdull;
+    key ^= key >> 33;
+    key *= 0xc4ceb9fe1a85ec53ull;
+    key ^= key >> 33;
+    return key;
+  }
+
+  /* Rehash the nodes of `table` into `num_buckets` (a power of two) buckets. */
+  void resize_subtable( Subtable& table, uint64_t num_buckets )
+  {
+    std::vector<index_t> buckets( num_buckets, 0u );
+    for ( auto n : table.buckets )
+    {
+      while ( n != 0 )
+      {
+        Node& N = nodes[n];
+        index_t const next = N.next;
+        index_t& head = buckets[unique_hash( N.T, N.E ) & ( num_buckets - 1u )];
+        N.next = head;
+        head = n;
+        n = next;
+      }
+    }
+    table.buckets.swap( buckets );
+  }
+
+  /* Top variable of the ZDD or ADD `f`, which follow the order of the variable indices
+   * (`num_vars` for the constants and the ADD terminals). */
+  var_t top_index( index_t f ) const
+  {
+    return get_node( f ).v;
+  }
+
+  /* The cofactors of the ZDD `f` with respect to `var`, which is not below its top variable:
+   * `f1` (the sets containing `var`, without it) and `f0` (the other sets). */
+  void zdd_cofactors( index_t f, var_t var, index_t& f0, index_t& f1 ) const
+  {
+    if ( top_index( f ) == var )
+    {
+      f1 = get_node( f ).T;
+      f0 = get_node( f ).E;
+    }
+    else
+    {
+      f1 = zdd_empty();
+      f0 = f;
+    }
+  }
+
+  /* Computes `zdd_union`, `zdd_intersection` or `zdd_difference` (after `op`). */
+  struct Zdd_Set_Op
+  {
+    Basic_BDD& m;
+    uint32_t op;
+
+    uint32_t code() const { return op; }
+    uint64_t& invocations() const { return m.num_invoke_zdd; }
+
+    bool reduce( index_t& f, index_t& g, index_t, index_t&, index_t& r ) const
+    {
+      if ( op == OP_ZDD_DIFFERENCE )
+      {
+        if ( f == zdd_empty() || g == zdd_empty() || f == g )
+        {
+          r = g == zdd_empty() ? f : zdd_empty();
+          return true;
+        }
+        return false;
+      }
+      if ( f == zdd_empty() || g == zdd_empty() || f == g )
+      {
+        r = op == OP_ZDD_UNION ? ( f == zdd_empty() ? g : f ) : ( f == g ? f : zdd_empty() );
+        return true;
+      }
+      if ( f > g )
+      {
+        std::swap( f, g );
+      }
+      return false;
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t& g, index_t& ) const
+    {
+      index_t f0, f1, g0, g1;
+      switch ( frame.step )
+      {
+      case 0u:
+        frame.x = std::min( m.top_index( frame.f ), m.top_index( frame.g ) );
+        m.zdd_cofactors( frame.f, frame.x, f0, f );
+        m.zdd_cofactors( frame.g, frame.x, g0, g );
+        return true;
+      case 1u:
+        frame.t[0] = r;
+        m.zdd_cofactors( frame.f, frame.x, f, f1 );
+        m.zdd_cofactors( frame.g, frame.x, g, g1 );
+        return true;
+      default:
+        r = m.zdd_unique( frame.x, frame.t[0], r );
+        return false;
+      }
+    }
+  };
+
+  /* Computes `zdd_change`, `zdd_subset0` or `zdd_subset1` (after `op`); `g` is the variable. */
+  struct Zdd_Var_Op
+  {
+    Basic_BDD& m;
+    uint32_t op;
+
+    uint32_t code() const { return op; }
+    uint64_t& invocations() const { return m.num_invoke_zdd; }
+
+    bool reduce( index_t& f, index_t& g, index_t, index_t&, index_t& r ) const
+    {
+      var_t const x = m.top_index( f ), var = g;
+      if ( op == OP_ZDD_CHANGE && f == zdd_empty() )
+      {
+        r = f;
+        return true;
+      }
+      if ( x > var )
+      {
+        r = op == OP_ZDD_CHANGE ? m.zdd_unique( var, f, zdd_empty() ) : op == OP_ZDD_SUBSET0 ? f : zdd_empty();
+        return true;
+      }
+      if ( x == var )
+      {
+        Node const& F = m.get_node( f );
+        r = op == OP_ZDD_CHANGE ? m.zdd_unique( var, F.E, F.T ) : op == OP_ZDD_SUBSET0 ? F.E : F.T;
+        return true;
+      }
+      return false;
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t& g, index_t& ) const
+    {
+      Node const& F = m.get_node( frame.f );
+      g = frame.g;
+      switch ( frame.step )
+      {
+      case 0u:
+        f = F.T;
+        return true;
+      case 1u:
+        frame.t[0] = r;
+        f = F.E;
+        return true;
+      default:
+        r = m.zdd_unique( F.v, frame.t[0], r );
+        return false;
+      }
+    }
+  };
+
+  /* Computes `zdd_product`: ( x f1 + f0 ) ( x g1 + g0 ) = x ( f1 g1 + f1 g0 + f0 g1 ) + f0 g0. */
+  struct Zdd_Product_Op
+  {
+    Basic_BDD& m;
+
+    uint32_t code() const { return OP_ZDD_PRODUCT; }
+    uint64_t& invocations() const { return m.num_invoke_zdd; }
+
+    bool reduce( index_t& f, index_t& g, index_t, index_t&, index_t& r ) const
+    {
+      if ( f == zdd_empty() || g == zdd_empty() )
+      {
+        r = zdd_empty();
+        return true;
+      }
+      if ( f == zdd_base() || g == zdd_base() )
+      {
+        r = f == zdd_base() ? g : f;
+        return true;
+      }
+      if ( f > g )
+      {
+        std::swap( f, g );
+      }
+      return false;
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t& g, index_t& ) const
+    {
+      if ( frame.step == 0u )
+      {
+        frame.x = std::min( m.top_index( frame.f ), m.top_index( frame.g ) );
+      }
+      else if ( frame.step == 1u )
+      {
+        frame.t[0] = r;
+      }
+      else if ( frame.step < 4u )
+      {
+        frame.t[0] = m.zdd_set_op( OP_ZDD_UNION, frame.t[0], r );
+      }
+      else
+      {
+        r = m.zdd_unique( frame.x, frame.t[0], r );
+        return false;
+      }
+      /* The products f1 g1, f1 g0, f0 g1 and f0 g0, in this order. */
+      index_t f0, f1, g0, g1;
+      m.zdd_cofactors( frame.f, frame.x, f0, f1 );
+      m.zdd_cofactors( frame.g, frame.x, g0, g1 );
+      f = frame.step < 2u ? f1 : f0;
+      g = frame.step % 2u == 0u ? g1 : g0;
+      return true;
+    }
+  };
+
+  /* Computes `zdd_divide`. Dividing by x g1 + g0, the quotient must divide both f1 by g1 and
+   * f0 by g0 (unless g0 is empty). */
+  struct Zdd_Divide_Op
+  {
+    Basic_BDD& m;
+
+    uint32_t code() const { return OP_ZDD_DIVIDE; }
+    uint64_t& invocations() const { return m.num_invoke_zdd; }
+
+    bool reduce( index_t& f, index_t& g, index_t, index_t&, index_t& r ) const
+    {
+      if ( g == zdd_base() || f == g )
+      {
+        r = g == zdd_base() ? f : zdd_base();
+        return true;
+      }
+      if ( m.top_index( f ) > m.top_index( g ) )
+      {
+        /* Some set of `g` contains a variable no set of `f` does. */
+        r = zdd_empty();
+        return true;
+      }
+      return false;
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t& g, index_t& ) const
+    {
+      Node const& G = m.get_node( frame.g );
+      switch ( frame.step )
+      {
+      case 0u:
+        f = m.zdd_var_op( OP_ZDD_SUBSET1, frame.f, G.v );
+        g = G.T;
+        return true;
+      case 1u:
+        if ( r == zdd_empty() || G.E == zdd_empty() )
+        {
+          return false;
+        }
+        frame.t[0] = r;
+        f = m.zdd_var_op( OP_ZDD_SUBSET0, frame.f, G.v );
+        g = G.E;
+        return true;
+      default:
+        r = m.zdd_set_op( OP_ZDD_INTERSECTION, frame.t[0], r );
+        return false;
+      }
+    }
+  };
+
+  /* Computes the ZDD of the satisfying assignments of the BDD `f`, as a family of sets of the
+   * variables from the level of `f` down (see `zdd_from_bdd`). The complemented edges are
+   * followed as such, so the results are memoized per edge, complement included. */
+  struct Zdd_From_Bdd_Op
+  {
+    Basic_BDD& m;
+
+    uint32_t code() const { return OP_ZDD_FROM_BDD; }
+    uint64_t& invocations() const { return m.num_invoke_zdd; }
+
+    bool reduce( index_t& f, index_t, index_t, index_t&, index_t& r ) const
+    {
+      if ( regular( f ) == constant( true ) )
+      {
+        r = f == constant( true ) ? zdd_base() : zdd_empty();
+        return true;
+      }
+      return false;
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t&, index_t& ) const
+    {
+      Node const& F = m.get_node( frame.f );
+      index_t const T = F.T ^ ( frame.f & 1 ), E = F.E ^ ( frame.f & 1 );
+      uint32_t const l = m.var2level[F.v];
+      switch ( frame.step )
+      {
+      case 0u:
+        f = T;
+        return true;
+      case 1u:
+        frame.t[0] = m.zdd_lift( r, m.level( T ), l + 1u );
+        f = E;
+        return true;
+      default:
+        r = m.zdd_join( F.v, frame.t[0], m.zdd_lift( r, m.level( E ), l + 1u ) );
+        return false;
+      }
+    }
+  };
+
+  /* Computes the BDD of the ZDD `f` over the variables from its top one on (the ones above are free). */
+  struct Zdd_To_Bdd_Op
+  {
+    Basic_BDD& m;
+
+    uint32_t code() const { return OP_ZDD_TO_BDD; }
+    uint64_t& invocations() const { return m.num_invoke_zdd; }
+
+    bool reduce( index_t& f, index_t, index_t, index_t&, index_t& r ) const
+    {
+      r = f;
+      return f == zdd_empty() || f == zdd_base();
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t&, index_t& ) const
+    {
+      Node const& F = m.get_node( frame.f );
+      switch ( frame.step )
+      {
+      case 0u:
+        f = F.T;
+        return true;
+      case 1u:
+        frame.t[0] = r;
+        f = F.E;
+        return true;
+      default:
+      {
+        /* The variables skipped between a node and its children are absent from the sets. */
+        index_t const r1 = m.apply<And_Op>( m.zdd_absent( F.v + 1u, m.top_index( F.T ) ), frame.t[0], 0 );
+        index_t const r0 = m.apply<And_Op>( m.zdd_absent( F.v + 1u, m.top_index( F.E ) ), r, 0 );
+        r = m.apply<Ite_Op>( m.literal( F.v ), r1, r0 );
+        return false;
+      }
+      }
+    }
+  };
+
+  /* `zdd_union`, `zdd_intersection` or `zdd_difference` (after `op`) within an operation. */
+  index_t zdd_set_op( uint32_t op, index_t f, index_t g )
+  {
+    return compute( Zdd_Set_Op( {*this, op} ), f, g, 0 );
+  }
+
+  /* `zdd_change`, `zdd_subset0` or `zdd_subset1` (after `op`) within an operation. */
+  index_t zdd_var_op( uint32_t op, index_t f, var_t var )
+  {
+    return compute( Zdd_Var_Op( {*this, op} ), f, var, 0 );
+  }
+
+  /* The family { a \cup { var } : a \in f1 } \cup f0, where `var` is in no set of `f1`. */
+  index_t zdd_join( var_t var, index_t f1, index_t f0 )
+  {
+    if ( var < top_index( f1 ) && var < top_index( f0 ) )
+    {
+      return zdd_unique( var, f1, f0 );
+    }
+    return zdd_set_op( OP_ZDD_UNION, zdd_var_op( OP_ZDD_CHANGE, f1, var ), f0 );
+  }
+
+  /* Extends the family `f` of sets of the variables from level `from` down to the variables from level
+   * `to` down, the variables of the levels in between being free (i.e., in some sets and not others). */
+  index_t zdd_lift( index_t f, uint32_t from, uint32_t to )
+  {
+    for ( uint32_t l = from; l-- > to; )
+    {
+      f = zdd_join( level2var[l], f, f );
+    }
+    return f;
+  }
+
+  /* The BDD of the conjunction of the negative literals of the variables from `first` to `last - 1`. */
+  index_t zdd_absent( var_t first, var_t last )
+  {
+    index_t r = constant( true );
+    for ( var_t v = first; v < last; ++v )
+    {
+      r = apply<And_Op>( r, literal( v, true ), 0 );
+    }
+    return r;
+  }
+
+  /* The operators of `Add_Apply`: `value` combines two constants, and `reduce` handles the
+   * other trivial cases, like the `reduce` of the BDD operators. */
+  struct Add_Plus_Op
+  {
+    static uint32_t code() { return OP_ADD_PLUS; }
+    static double value( double a, double b ) { return a + b; }
+    static bool reduce( index_t& f, index_t& g, index_t& r )
+    {
+      if ( f == constant( false ) || g == constant( false ) )
+      {
+        r = f == constant( false ) ? g : f;
+        return true;
+      }
+      if ( f > g )
+      {
+        std::swap( f, g );
+      }
+      return false;
+    }
+  };
+
+  struct Add_Times_Op
+  {
+    static uint32_t code() { return OP_ADD_TIMES; }
+    static double value( double a, double b ) { return a * b; }
+    static bool reduce( index_t& f, index_t& g, index_t& r )
+    {
+      if ( f == constant( false ) || g == constant( false ) )
+      {
+        r = constant( false );
+        return true;
+      }
+      if ( f == constant( true ) || g == constant( true ) )
+      {
+        r = f == constant( true ) ? g : f;
+        return true;
+      }
+      if ( f > g )
+      {
+        std::swap( f, g );
+      }
+      return false;
+    }
+  };
+
+  struct Add_Min_Op
+  {
+    static uint32_t code() { return OP_ADD_MIN; }
+    static double value( double a, double b ) { return std::min( a, b ); }
+    static bool reduce( index_t& f, index_t& g, index_t& r )
+    {
+      if ( f == g )
+      {
+        r = f;
+        return true;
+      }
+      if ( f > g )
+      {
+        std::swap( f, g );
+      }
+      return false;
+    }
+  };
+
+  struct Add_Max_Op
+  {
+    static uint32_t code() { return OP_ADD_MAX; }
+    static double value( double a, double b ) { return std::max( a, b ); }
+    static bool reduce( index_t& f, index_t& g, index_t& r )
+    {
+      if ( f == g )
+      {
+        r = f;
+        return true;
+      }
+      if ( f > g )
+      {
+        std::swap( f, g );
+      }
+      return false;
+    }
+  };
+
+  struct Add_Threshold_Op
+  {
+    static uint32_t code() { return OP_ADD_THRESHOLD; }
+    static double value( double a, double b ) { return a >= b ? 1.0 : 0.0; }
+    static bool reduce( index_t& f, index_t& g, index_t& r )
+    {
+      if ( f == g )
+      {
+        r = constant( true );
+        return true;
+      }
+      return false;
+    }
+  };
+
+  /* The cofactors of the ADD `f` with respect to `var`, which is not below its top variable. */
+  void add_cofactors( index_t f, var_t var, index_t& f0, index_t& f1 ) const
+  {
+    if ( top_index( f ) == var )
+    {
+      f1 = get_node( f ).T;
+      f0 = get_node( f ).E;
+    }
+    else
+    {
+      f1 = f0 = f;
+    }
+  }
+
+  /* Computes `Op( f, g )` for an ADD operator `Op`. */
+  template<typename Op>
+  struct Add_Apply
+  {
+    Basic_BDD& m;
+
+    uint32_t code() const { return Op::code(); }
+    uint64_t& invocations() const { return m.num_invoke_add; }
+
+    bool reduce( index_t& f, index_t& g, index_t, index_t&, index_t& r ) const
+    {
+      if ( Op::reduce( f, g, r ) )
+      {
+        return true;
+      }
+      if ( m.is_add_constant( f ) && m.is_add_constant( g ) )
+      {
+        r = m.add_constant( Op::value( m.add_value( f ), m.add_value( g ) ) );
+        return true;
+      }
+      return false;
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t& g, index_t& ) const
+    {
+      index_t f0, f1, g0, g1;
+      switch ( frame.step )
+      {
+      case 0u:
+        frame.x = std::min( m.top_index( frame.f ), m.top_index( frame.g ) );
+        m.add_cofactors( frame.f, frame.x, f0, f );
+        m.add_cofactors( frame.g, frame.x, g0, g );
+        return true;
+      case 1u:
+        frame.t[0] = r;
+        m.add_cofactors( frame.f, frame.x, f, f1 );
+        m.add_cofactors( frame.g, frame.x, g, g1 );
+        return true;
+      default:
+        r = m.add_unique( frame.x, frame.t[0], r );
+        return false;
+      }
+    }
+  };
+
+  /* `Op( f, g )` for an ADD operator `Op` within an operation. */
+  template<typename Op>
+  index_t add_apply( index_t f, index_t g )
+  {
+    return compute( Add_Apply<Op>( {*this} ), f, g, 0 );
+  }
+
+  /* The 0-1 ADD of the positive cube `cube` (a BDD), whose variables are in index order. */
+  index_t add_cube( index_t cube )
+  {
+    std::vector<bool> in_cube( num_vars(), false );
+    for ( ; cube != constant( true ); cube = get_node( cube ).T )
+    {
+      assert( !is_complemented( cube ) && get_node( cube ).E == constant( false ) && "Make sure the cube is a conjunction of positive literals." );
+      in_cube[get_node( cube ).v] = true;
+    }
+    index_t r = constant( true );
+    for ( var_t v = num_vars(); v-- > 0u; )
+    {
+      if ( in_cube[v] )
+      {
+        r = add_unique( v, r, constant( false ) );
+      }
+    }
+    return r;
+  }
+
+  /* Computes the sum (if `sum`) or the maximum of the cofactors of `f` over the variables of the
+   * ADD cube `g` (see `add_cube`). Summing over a variable `f` does not depend on doubles it: as in
+   * CUDD, the results are doubled for the variables of `g` skipped between a node of `f` and its
+   * children, so that no intermediate value exceeds the result. */
+  template<bool sum>
+  struct Add_Abstract_Op
+  {
+    Basic_BDD& m;
+
+    uint32_t code() const { return sum ? OP_ADD_SUM_ABSTRACT : OP_ADD_MAX_ABSTRACT; }
+    uint64_t& invocations() const { return m.num_invoke_add; }
+
+    bool reduce( index_t& f, index_t& g, index_t, index_t&, index_t& r ) const
+    {
+      r = f;
+      return g == constant( true ) || ( sum ? f == constant( false ) : m.is_add_constant( f ) );
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t& g, index_t& ) const
+    {
+      Node const& F = m.get_node( frame.f );
+      index_t const below = m.top_index( frame.g ) == F.v ? m.get_node( frame.g ).T : frame.g;
+      switch ( frame.step )
+      {
+      case 0u:
+        if ( m.top_index( frame.g ) < F.v )
+        {
+          /* Skip the variables of the cube above `f`, counting them in `t[1]`. */
+          f = frame.f;
+          frame.t[1] = 0;
+          for ( g = frame.g; m.top_index( g ) < F.v; g = m.get_node( g ).T )
+          {
+            ++frame.t[1];
+          }
+          frame.step = 2u;
+          return true;
+        }
+        f = F.T;
+        g = below;
+        return true;
+      case 1u:
+        frame.t[0] = r;
+        f = F.E;
+        g = below;
+        return true;
+      case 2u:
+        if ( m.top_index( frame.g ) != F.v )
+        {
+          r = m.add_unique( F.v, frame.t[0], r );
+        }
+        else
+        {
+          r = sum ? m.add_apply<Add_Plus_Op>( frame.t[0], r ) : m.add_apply<Add_Max_Op>( frame.t[0], r );
+        }
+        return false;
+      default:
+        if ( sum )
+        {
+          r = m.add_apply<Add_Times_Op>( r, m.add_constant( std::ldexp( 1.0, int( frame.t[1] ) ) ) );
+        }
+        return false;
+      }
+    }
+  };
+
+  /* Computes the 0-1 ADD of the BDD `f`, as x f1 + ~x f0 for its top variable x (in any order). */
+  struct Add_From_Bdd_Op
+  {
+    Basic_BDD& m;
+
+    uint32_t code() const { return OP_ADD_FROM_BDD; }
+    uint64_t& invocations() const { return m.num_invoke_add; }
+
+    bool reduce( index_t& f, index_t, index_t, index_t&, index_t& r ) const
+    {
+      r = f;
+      return regular( f ) == constant( true );
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t&, index_t& ) const
+    {
+      Node const& F = m.get_node( frame.f );
+      switch ( frame.step )
+      {
+      case 0u:
+        f = F.T ^ ( frame.f & 1 );
+        return true;
+      case 1u:
+        frame.t[0] = r;
+        f = F.E ^ ( frame.f & 1 );
+        return true;
+      default:
+      {
+        index_t const r1 = m.add_apply<Add_Times_Op>( m.add_unique( F.v, constant( true ), constant( false ) ), frame.t[0] );
+        index_t const r0 = m.add_apply<Add_Times_Op>( m.add_unique( F.v, constant( false ), constant( true ) ), r );
+        r = m.add_apply<Add_Plus_Op>( r1, r0 );
+        return false;
+      }
+      }
+    }
+  };
+
+  /* Computes the BDD of the assignments where the ADD `f` is at least the constant ADD `g`. */
+  struct Add_To_Bdd_Op
+  {
+    Basic_BDD& m;
+
+    uint32_t code() const { return OP_ADD_TO_BDD; }
+    uint64_t& invocations() const { return m.num_invoke_add; }
+
+    bool reduce( index_t& f, index_t& g, index_t, index_t&, index_t& r ) const
+    {
+      if ( m.is_add_constant( f ) )
+      {
+        r = constant( m.add_value( f ) >= m.add_value( g ) );
+        return true;
+      }
+      return false;
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t& g, index_t& ) const
+    {
+      Node const& F = m.get_node( frame.f );
+      g = frame.g;
+      switch ( frame.step )
+      {
+      case 0u:
+        f = F.T;
+        return true;
+      case 1u:
+        frame.t[0] = r;
+        f = F.E;
+        return true;
+      default:
+        r = m.apply<Ite_Op>( m.literal( F.v ), frame.t[0], r );
+        return false;
+      }
+    }
+  };
+
+  /* Computes the BDD of the ISOP cover of [lower, upper] (see `isop`), splitting on their top
+   * variable x: the cubes with ~x cover the part of the negative cofactor of `lower` that no cube
+   * without x can cover, the cubes with x likewise, and the cubes without x the rest. With `cube`,
+   * which holds the literals of the pending calls, every cube of the cover is also listed in
+   * `cubes`; these calls are not memoized, as a result from the computed table would skip the
+   * cubes below it. */
+  struct Isop_Op
+  {
+    Basic_BDD& m;
+    Cube* cube;
+    std::vector<Cube>* cubes;
+
+    uint32_t code() const { return cube == nullptr ? OP_ISOP : OP_NONE; }
+    uint64_t& invocations() const { return m.num_invoke_isop; }
+
+    bool reduce( index_t lower, index_t upper, index_t, index_t&, index_t& r ) const
+    {
+      if ( lower != m.constant( false ) && upper != m.constant( true ) )
+      {
+        return false;
+      }
+      /* The empty cover, or the cover with the empty cube. */
+      bool const tautology = lower != m.constant( false );
+      if ( tautology && cube != nullptr )
+      {
+        cubes->emplace_back( *cube );
+      }
+      r = m.constant( tautology );
+      return true;
+    }
+
+    bool step( Compute_Frame& frame, index_t& r, index_t& f, index_t& g, index_t& h ) const
+    {
+      if ( frame.step == 0u )
+      {
+        frame.x = m.top_var( frame.f, frame.g );
+      }
+      h = 0;
+      switch ( frame.step )
+      {
+      case 0u:
+      case 1u:
+        if ( frame.step == 1u )
+        {
+          frame.t[0] = r;
+        }
+        set_literal( frame.x, int8_t( frame.step ) );
+        m.isop_subproblem( frame.f, frame.g, frame.x, frame.step, f, g );
+        return true;
+      case 2u:
+        frame.t[1] = r;
+        set_literal( frame.x, -1 );
+        m.isop_subproblem( frame.f, frame.g, frame.x, 2u, f, g, frame.t[0], frame.t[1] );
+        return true;
+      default:
+        r = m.apply<Or_Op>( m.apply<Ite_Op>( m.literal( frame.x ), frame.t[1], frame.t[0] ), r, 0 );
+        return false;
+      }
+    }
+
+    void set_literal( var_t x, int8_t polarity ) const
+    {
+      if ( cube != nullptr )
+      {
+        ( *cube )[x] = polarity;
+      }
+    }
+  };
 
-    return num_nodes_rec( f, visited );
+  /* Operands `lower_k` and `upper_k` of the `k`-th subproblem of the ISOP of [lower, upper] split on
+   * `x` (see `Isop_Op`): the cubes with ~x, with x, and without x, the last one given the covers
+   * `t0` and `t1` of the first two. */
+  void isop_subproblem( index_t lower, index_t upper, var_t x, uint32_t k, index_t& lower_k, index_t& upper_k, index_t t0 = 0, index_t t1 = 0 )
+  {
+    index_t l0, l1, u0, u1;
+    cofactors( lower, x, l0, l1 );
+    cofactors( upper, x, u0, u1 );
+    switch ( k )
+    {
+    case 0u:
+      lower_k = apply<And_Op>( l0, u1 ^ 1, 0 );
+      upper_k = u0;
+      break;
+    case 1u:
+      lower_k = apply<And_Op>( l1, u0 ^ 1, 0 );
+      upper_k = u1;
+      break;
+    default:
+      lower_k = apply<Or_Op>( apply<And_Op>( l0, t0 ^ 1, 0 ), apply<And_Op>( l1, t1 ^ 1, 0 ), 0 );
+      upper_k = apply<And_Op>( u0, u1, 0 );
+    }
   }
 
-  uint64_t num_invoke() const
+  /* Number of cubes of the ISOP cover of [lower, upper], memoized per pair of operands. The covers
+   * of the first two subproblems, needed for the operands of the third, come from the computed table. */
+  uint64_t isop_count( index_t lower, index_t upper )
+  {
+    struct Count_Frame
+    {
+      index_t lower, upper;
+      bool expanded;
+      index_t sub[3][2];
+    };
+    std::unordered_map<std::pair<index_t, index_t>, uint64_t, Edge_Pair_Hash> counts;
+    std::vector<Count_Frame> stack( 1u, Count_Frame( {lower, upper, false, {}} ) );
+    while ( !stack.empty() )
+    {
+      Count_Frame& frame = stack.back();
+      auto const key = std::make_pair( frame.lower, frame.upper );
+      if ( counts.count( key ) )
+      {
+        stack.pop_back();
+        continue;
+      }
+      if ( frame.lower == constant( false ) || frame.upper == constant( true ) )
+      {
+        /* The empty cover, or the cover with the empty cube. */
+        counts.emplace( key, frame.lower != constant( false ) ? 1u : 0u );
+        stack.pop_back();
+        continue;
+      }
+      if ( frame.expanded )
+      {
+        counts.emplace( key, counts.at( std::make_pair( frame.sub[0][0], frame.sub[0][1] ) ) +
+                                 counts.at( std::make_pair( frame.sub[1][0], frame.sub[1][1] ) ) +
+                                 counts.at( std::make_pair( frame.sub[2][0], frame.sub[2][1] ) ) );
+        stack.pop_back();
+        continue;
+      }
+      frame.expanded = true;
+      var_t const x = top_var( frame.lower, frame.upper );
+      index_t t[2];
+      for ( auto k = 0u; k < 2u; ++k )
+      {
+        isop_subproblem( frame.lower, frame.upper, x, k, frame.sub[k][0], frame.sub[k][1] );
+        t[k] = compute( Isop_Op( {*this, nullptr, nullptr} ), frame.sub[k][0], frame.sub[k][1], 0 );
+      }
+      isop_subproblem( frame.lower, frame.upper, x, 2u, frame.sub[2][0], frame.sub[2][1], t[0], t[1] );
+      Count_Frame children[3];
+      for ( auto k = 0u; k < 3u; ++k )
+      {
+        children[k] = Count_Frame( {frame.sub[k][0], frame.sub[k][1], false, {}} );
+      }
+      stack.insert( stack.end(), children, children + 3 ); /* invalidates `frame` */
+    }
+    return counts.at( std::make_pair( lower, upper ) );
+  }
+
+  /* Whether `f` implies `g`, without building any node. */
+  bool implies( index_t f, index_t g ) const
   {
-    return num_invoke_not + num_invoke_and + num_invoke_or + num_invoke_xor + num_invoke_ite;
+    std::unordered_map<std::pair<index_t, index_t>, bool, Edge_Pair_Hash> visited;
+    std::vector<std::pair<index_t, index_t>> stack( 1u, std::make_pair( f, g ) );
+    while ( !stack.empty() )
+    {
+      f = stack.back().first;
+      g = stack.back().second;
+      stack.pop_back();
+      if ( f == constant( false ) || g == constant( true ) || f == g || !visited.emplace( std::make_pair( f, g ), true ).second )
+      {
+        continue;
+      }
+      if ( f == constant( true ) || g == constant( false ) || f == ( g ^ 1 ) )
+      {
+        return false;
+      }
+      var_t const x = top_var( f, g );
+      index_t f0, f1, g0, g1;
+      cofactors( f, x, f0, f1 );
+      cofactors( g, x, g0, g1 );
+      stack.emplace_back( f0, g0 );
+      stack.emplace_back( f1, g1 );
+    }
+    return true;
   }
 
-private:
-  /**********************************************************/
-  /******************** Helper Functions ********************/
-  /**********************************************************/
+  /* Hash of a pair of edges, for memos keyed by the operands of a binary operation. */
+  struct Edge_Pair_Hash
+  {
+    std::size_t operator()( std::pair<index_t, index_t> const& p ) const
+    {
+      return std::size_t( unique_hash( p.first, p.second ) );
+    }
+  };
 
-  uint64_t num_nodes_rec( index_t f, std::vector<bool>& visited ) const
+  /* Find the node with variable `var` and children `T` and `E` in `table`, the unique table of `var`
+   * (of the BDDs or of the ZDDs), or build it. Returns the (regular) edge to the node. */
+  index_t find_or_add( Subtable& table, var_t var, index_t T, index_t E )
   {
-    assert( f < nodes.size() && "Make sure f exists." );
-    
+    /* Look up in the unique table. */
+    index_t& head = table.buckets[unique_hash( T, E ) & ( table.buckets.size() - 1u )];
+    ++num_unique_lookup;
+    /* The ZDD and ADD subtables are in variable order: count their lookups apart. */
+    BDD_INSTRUMENT( bool const diagram = &table != &unique_table[var]; uint32_t const l = diagram ? var : var2level[var];
+                    ++( diagram ? instr.diagram_lookups : instr.unique_lookups )[l]; )
+    for ( index_t n = head; n != 0; n = nodes[n].next )
+    {
+      ++num_unique_probe;
+      BDD_INSTRUMENT( ++( diagram ? instr.diagram_probes : instr.unique_probes )[l]; )
+      if ( nodes[n].T == T && nodes[n].E == E )
+      {
+        /* The required node already exists. Return it. */
+        return n << 1;
+      }
+      BDD_INSTRUMENT( ++( diagram ? instr.diagram_collisions : instr.unique_collisions )[l]; )
+    }
 
-    uint64_t n = 0u;
-    Node const& F = nodes[f];
-    assert( F.T < nodes.size() && "Make sure the children exist." );
-    assert( F.E < nodes.size() && "Make sure the children exist." );
-    if ( !visited[F.T] )
+    /* Create a new node and insert it to the unique table. */
+    index_t const new_index = new_node( Node( {T, E, head, var, 0} ) );
+    head = new_index;
+
+    if ( ++table.num_entries > table.buckets.size() )
+    {
+      /* Keep the average chain length below one. */
+      resize_subtable( table, table.buckets.size() << 1 );
+    }
+    return new_index << 1;
+  }
+
+  /* Store `node` in a new slot (recycling a freed one if there is one) and return its index.
+   * The node is dead until it is referenced by `ref` (directly or through a parent). */
+  index_t new_node( Node const& node )
+  {
+    index_t n;
+    if ( free_list.empty() )
+    {
+      check_memory_limit();
+      n = nodes.size();
+      nodes.emplace_back( node );
+    }
+    else
+    {
+      n = free_list.back();
+      free_list.pop_back();
+      nodes[n] = node;
+      ++num_recycled;
+    }
+    ++num_dead;
+    BDD_INSTRUMENT( ++instr.allocated_nodes; )
+    return n;
+  }
+
+  /* The node pointed to by edge `f`. */
+  Node const& get_node( index_t f ) const
+  {
+    return nodes[f >> 1];
+  }
+
+  /* Human-readable name of edge `f`: the node index, preceded by `~` if complemented. */
+  static std::string edge_name( index_t f )
+  {
+    return ( is_complemented( f ) ? "~" : "" ) + std::to_string( f >> 1 );
+  }
+
+  /* Negative (`f0`) and positive (`f1`) cofactors of edge `f` with respect to variable `x`,
+   * where `x` is not below the top variable of `f`. */
+  void cofactors( index_t f, var_t x, index_t& f0, index_t& f1 ) const
+  {
+    Node const& F = get_node( f );
+    if ( F.v == x )
+    {
+      f0 = F.E ^ ( f & 1 );
+      f1 = F.T ^ ( f & 1 );
+    }
+    else
+    {
+      f0 = f1 = f;
+    }
+  }
+
+  /* Thread-safe version of `unique` for the parallel operations. Returns false (and aborts
+   * the parallel operation) if a new node is needed but no reserved slot is left.
+   *
+   * A new node is published by a compare-and-swap of the head of its bucket, so the chains
+   * only ever grow at their head while the other threads are reading them. If the head
+   * changed meanwhile, the nodes inserted since are checked for a duplicate before retrying. */
+  bool unique_concurrent( var_t var, index_t T, index_t E, index_t& r, Worker_Context& w )
+  {
+    if ( T == E )
+    {
+      r = T;
+      return true;
+    }
+    if ( is_complemented( T ) )
+    {
+      bool const ok = unique_concurrent( var, T ^ 1, E ^ 1, r, w );
+      r ^= 1;
+      return ok;
+    }
+
+    Subtable& table = unique_table[var];
+    index_t* const bucket = &table.buckets[unique_hash( T, E ) & ( table.buckets.size() - 1u )];
+    index_t head = __atomic_load_n( bucket, __ATOMIC_ACQUIRE );
+    ++w.unique_lookup;
+    for ( index_t n = head; n != 0; n = nodes[n].next )
+    {
+      ++w.unique_probe;
+      if ( nodes[n].T == T && nodes[n].E == E )
+      {
+        r = n << 1;
+        return true;
+      }
+    }
+
+    if ( w.slots.empty() )
+    {
+      std::lock_guard<std::mutex> lock( slot_mutex );
+      for ( auto i = 0u; i < 256u && !free_list.empty(); ++i )
+      {
+        w.slots.emplace_back( free_list.back() );
+        free_list.pop_back();
+      }
+      if ( w.slots.empty() )
+      {
+        parallel_aborted.store( true );
+        return false;
+      }
+    }
+    index_t const n = w.slots.back();
+    nodes[n] = Node( {T, E, head, var, 0} );
+
+    while ( !__atomic_compare_exchange_n( bucket, &head, n, false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE ) )
+    {
+      /* `head` now holds the new head of the bucket. */
+      for ( index_t m = head; m != nodes[n].next; m = nodes[m].next )
+      {
+        if ( nodes[m].T == T && nodes[m].E == E )
+        {
+          /* The slot stays reserved, and goes back to the free list unused: mark it free again. */
+          nodes[n].v = free_var();
+          r = m << 1;
+          return true;
+        }
+      }
+      nodes[n].next = head;
+    }
+
+    w.slots.pop_back();
+    __atomic_fetch_add( &table.num_entries, 1u, __ATOMIC_RELAXED );
+    ++w.new_nodes;
+    r = n << 1;
+    return true;
+  }
+
+  /* Thread-safe version of `cache_lookup`. The fields of an entry are read between two reads
+   * of its sequence number, and the read is discarded if that number is odd or has changed. */
+  bool cache_lookup_concurrent( uint32_t op, index_t f, index_t g, index_t h, index_t& r, Worker_Context& w )
+  {
+    Cache_Entry& entry = computed_table[cache_hash( op, f, g, h )];
+    uint32_t const seq = __atomic_load_n( &entry.seq, __ATOMIC_ACQUIRE );
+    if ( ( seq & 1u ) == 0u )
+    {
+      uint32_t const e_op = __atomic_load_n( &entry.op, __ATOMIC_RELAXED );
+      index_t const e_f = __atomic_load_n( &entry.f, __ATOMIC_RELAXED );
+      index_t const e_g = __atomic_load_n( &entry.g, __ATOMIC_RELAXED );
+      index_t const e_h = __atomic_load_n( &entry.h, __ATOMIC_RELAXED );
+      index_t const e_r = __atomic_load_n( &entry.r, __ATOMIC_RELAXED );
+      __atomic_thread_fence( __ATOMIC_ACQUIRE );
+      if ( __atomic_load_n( &entry.seq, __ATOMIC_RELAXED ) == seq && e_op == op && e_f == f && e_g == g && e_h == h )
+      {
+        ++w.cache_hit;
+        r = e_r;
+        return true;
+      }
+    }
+    ++w.cache_miss;
+    return false;
+  }
+
+  /* Thread-safe version of `cache_insert`. The writer makes the sequence number of the entry odd
+   * with a compare-and-swap, writes the fields and makes it even again. An entry being written
+   * by another thread is left alone: the table is lossy anyway. */
+  void cache_insert_concurrent( uint32_t op, index_t f, index_t g, index_t h, index_t r, Worker_Context& w )
+  {
+    Cache_Entry& entry = computed_table[cache_hash( op, f, g, h )];
+    uint32_t seq = __atomic_load_n( &entry.seq, __ATOMIC_RELAXED );
+    if ( ( seq & 1u ) != 0u ||
+         !__atomic_compare_exchange_n( &entry.seq, &seq, seq + 1u, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) )
+    {
+      return;
+    }
+    __atomic_thread_fence( __ATOMIC_RELEASE );
+    if ( __atomic_load_n( &entry.op, __ATOMIC_RELAXED ) != OP_NONE )
+    {
+      ++w.cache_eviction;
+    }
+    __atomic_store_n( &entry.op, op, __ATOMIC_RELAXED );
+    __atomic_store_n( &entry.f, f, __ATOMIC_RELAXED );
+    __atomic_store_n( &entry.g, g, __ATOMIC_RELAXED );
+    __atomic_store_n( &entry.h, h, __ATOMIC_RELAXED );
+    __atomic_store_n( &entry.r, r, __ATOMIC_RELAXED );
+    __atomic_store_n( &entry.seq, seq + 2u, __ATOMIC_RELEASE );
+  }
+
+  static char const* file_magic()
+  {
+    return "BDD\x1a";
+  }
+
+  static uint64_t file_version()
+  {
+    return 1u;
+  }
+
+  /* Write `value` in LEB128: 7 bits per byte, the lowest first, the high bit marking continuation. */
+  static void write_varint( std::ostream& os, uint64_t value )
+  {
+    while ( value >= 0x80u )
+    {
+      os.put( char( ( value & 0x7fu ) | 0x80u ) );
+      value >>= 7;
+    }
+    os.put( char( value ) );
+  }
+
+  /* Read a value written by `write_varint` at `data`, advancing it. */
+  static uint64_t read_varint( uint8_t const*& data, uint8_t const* end )
+  {
+    uint64_t value = 0u;
+    for ( uint32_t shift = 0u; shift < 64u; shift += 7u )
+    {
+      if ( data == end )
+      {
+        throw std::runtime_error( "truncated BDD file" );
+      }
+      uint8_t const byte = *data++;
+      value |= uint64_t( byte & 0x7fu ) << shift;
+      if ( ( byte & 0x80u ) == 0u )
+      {
+        return value;
+      }
+    }
+    throw std::runtime_error( "invalid number in the BDD file" );
+  }
+
+  /* The BDD of the function given by `word` over the variables `order[l]` (the most significant)
+   * to `order.back()` (the least significant). */
+  index_t from_word( uint64_t word, uint32_t l, std::vector<var_t> const& order )
+  {
+    if ( l == order.size() )
+    {
+      return constant( word & 1u );
+    }
+    uint32_t const half = 1u << ( order.size() - l - 1u );
+    uint64_t const low = word & length_mask[order.size() - l - 1u];
+    uint64_t const high = ( word >> half ) & length_mask[order.size() - l - 1u];
+    if ( low == high )
+    {
+      return from_word( low, l + 1u, order );
+    }
+    return unique( order[l], from_word( high, l + 1u, order ), from_word( low, l + 1u, order ) );
+  }
+
+  /* Base-2 logarithm of the fraction of the assignments satisfying `f`. `fractions` gets the logarithms
+   * of the fractions of the assignments satisfying, and not satisfying, each node below `f`.
+   * Keeping both, in the logarithmic domain, avoids underflows and the cancellation of 1 - p. */
+  long double log2_fraction( index_t f, std::unordered_map<index_t, std::pair<long double, long double>>& fractions ) const
+  {
+    /* log2( ( 2^a + 2^b ) / 2 ) */
+    auto const log2_mean = []( long double a, long double b ) {
+      if ( a < b )
+      {
+        std::swap( a, b );
+      }
+      return std::isinf( b ) ? a - 1.0L : a + std::log2( 1.0L + std::exp2( b - a ) ) - 1.0L;
+    };
+    auto const log2_of = [&]( index_t g ) {
+      auto const& fraction = fractions.at( g >> 1 );
+      return is_complemented( g ) ? fraction.second : fraction.first;
+    };
+
+    fractions.emplace( 0u, std::make_pair( 0.0L, -std::numeric_limits<long double>::infinity() ) );
+    std::vector<std::pair<index_t, bool>> stack( 1u, std::make_pair( f >> 1, false ) );
+    while ( !stack.empty() )
+    {
+      index_t const n = stack.back().first;
+      bool const expanded = stack.back().second;
+      if ( fractions.count( n ) )
+      {
+        stack.pop_back();
+        continue;
+      }
+      Node const& N = nodes[n];
+      if ( !expanded )
+      {
+        stack.back().second = true;
+        stack.emplace_back( N.T >> 1, false );
+        stack.emplace_back( N.E >> 1, false );
+        continue;
+      }
+      stack.pop_back();
+      fractions.emplace( n, std::make_pair( log2_mean( log2_of( N.T ), log2_of( N.E ) ),
+                                            log2_mean( log2_of( N.T ^ 1 ), log2_of( N.E ^ 1 ) ) ) );
+    }
+    return log2_of( f );
+  }
+
+  /* Number of assignments of the levels from `level( f )` to the bottom satisfying `f`.
+   * `counts` gets the counts of the regular nodes below `f`, each over the levels from its own. */
+  long double sat_count_below( index_t f, std::unordered_map<index_t, long double>& counts ) const
+  {
+    auto const count_of = [&]( index_t g ) {
+      long double const count = counts.at( g >> 1 );
+      return is_complemented( g ) ? std::ldexp( 1.0L, num_vars() - level( g ) ) - count : count;
+    };
+
+    counts.emplace( 0u, 1.0L );
+    std::vector<std::pair<index_t, bool>> stack( 1u, std::make_pair( f >> 1, false ) );
+    while ( !stack.empty() )
+    {
+      index_t const n = stack.back().first;
+      bool const expanded = stack.back().second;
+      if ( counts.count( n ) )
+      {
+        stack.pop_back();
+        continue;
+      }
+      Node const& N = nodes[n];
+      if ( !expanded )
+      {
+        stack.back().second = true;
+        stack.emplace_back( N.T >> 1, false );
+        stack.emplace_back( N.E >> 1, false );
+        continue;
+      }
+      stack.pop_back();
+      uint32_t const l = var2level[N.v];
+      counts.emplace( n, std::ldexp( count_of( N.T ), level( N.T ) - l - 1u ) + std::ldexp( count_of( N.E ), level( N.E ) - l - 1u ) );
+    }
+    return count_of( f );
+  }
+
+  /* Truth table (in level order, see `get_tt`) of `f` over the levels from `l` to the bottom,
+   * if there are at most 5 of them. `memo` holds the tables of the regular nodes at their own level. */
+  uint64_t tt_small( index_t f, uint32_t l, std::unordered_map<index_t, uint64_t>& memo ) const
+  {
+    uint32_t const k = num_vars() - l; /* number of levels */
+    if ( f == constant( false ) || f == constant( true ) )
+    {
+      return f == constant( true ) ? length_mask[k] : 0u;
+    }
+
+    uint32_t const lf = level( f );
+    if ( lf > l )
+    {
+      /* `f` does not depend on the levels from `l` to `lf - 1`, the most significant bits. */
+      uint64_t table = tt_small( f, lf, memo );
+      for ( auto i = num_vars() - lf; i < k; ++i )
+      {
+        table |= table << ( 1u << i );
+      }
+      return table;
+    }
+
+    auto it = memo.find( f >> 1 );
+    if ( it == memo.end() )
+    {
+      Node const& N = get_node( f );
+      uint64_t const table = tt_small( N.E, l + 1u, memo ) | ( tt_small( N.T, l + 1u, memo ) << ( 1u << ( k - 1u ) ) );
+      it = memo.emplace( f >> 1, table ).first;
+    }
+    return is_complemented( f ) ? ~it->second & length_mask[k] : it->second;
+  }
+
+  /* Write the truth table (in level order, see `get_tt`) of `f` over the levels from `l` to the bottom,
+   * if there are at least 6 of them, into `block`. `blocks` holds the block written for each
+   * regular node at its own level, and the edge written there. */
+  void tt_fill( index_t f, uint32_t l, uint64_t* block, std::unordered_map<index_t, uint64_t>& small_tables,
+                std::unordered_map<index_t, std::pair<uint64_t const*, index_t>>& blocks ) const
+  {
+    uint64_t const size = uint64_t( 1u ) << ( num_vars() - l - 6u ); /* in words */
+    if ( f == constant( false ) || f == constant( true ) )
+    {
+      std::fill( block, block + size, f == constant( true ) ? ~uint64_t( 0u ) : 0u );
+      return;
+    }
+
+    uint32_t const lf = level( f );
+    if ( lf > l )
+    {
+      /* Repeat the block of `f` at its own level. */
+      if ( num_vars() - lf < 6u )
+      {
+        uint64_t word = tt_small( f, lf, small_tables );
+        for ( auto i = num_vars() - lf; i < 6u; ++i )
+        {
+          word |= word << ( 1u << i );
+        }
+        std::fill( block, block + size, word );
+      }
+      else
+      {
+        uint64_t const sub_size = uint64_t( 1u ) << ( num_vars() - lf - 6u );
+        tt_fill( f, lf, block, small_tables, blocks );
+        for ( uint64_t i = sub_size; i < size; i += sub_size )
+        {
+          std::copy( block, block + sub_size, block + i );
+        }
+      }
+      return;
+    }
+
+    auto const it = blocks.find( f >> 1 );
+    if ( it != blocks.end() )
+    {
+      if ( it->second.second == f )
+      {
+        std::copy( it->second.first, it->second.first + size, block );
+      }
+      else
+      {
+        word_kernels().not_words( block, it->second.first, size );
+      }
+      return;
+    }
+
+    /* The negative cofactor is the lower half, the complement being pushed to the children. */
+    Node const& N = get_node( f );
+    index_t const c = f & 1;
+    if ( size == 1u )
+    {
+      block[0] = tt_small( N.E ^ c, l + 1u, small_tables ) | ( tt_small( N.T ^ c, l + 1u, small_tables ) << 32u );
+    }
+    else
+    {
+      tt_fill( N.E ^ c, l + 1u, block, small_tables, blocks );
+      tt_fill( N.T ^ c, l + 1u, block + size / 2u, small_tables, blocks );
+    }
+    blocks.emplace( f >> 1, std::make_pair( block, f ) );
+  }
+
+  /* Position of the operation `op( f, g, h )` in the computed table. */
+  uint64_t cache_hash( uint32_t op, index_t f, index_t g, index_t h ) const
+  {
+    uint64_t key = op;
+    key = key * 0x9e3779b97f4a7c15ull + f;
+    key = key * 0x9e3779b97f4a7c15ull + g;
+    key = key * 0x9e3779b97f4a7c15ull + h;
+    key ^= key >> 29;
+    key *= 0xbf58476d1ce4e5b9ull;
+    key ^= key >> 32;
+    return key & ( computed_table.size() - 1u );
+  }
+
+  /* Look up the result of `op( f, g, h )` in the computed table.
+   * Returns true (and sets `r`) if it was computed before and not overwritten since. */
+  bool cache_lookup( uint32_t op, index_t f, index_t g, index_t h, index_t& r )
+  {
+    Cache_Entry const& entry = computed_table[cache_hash( op, f, g, h )];
+    if ( entry.op == op && entry.f == f && entry.g == g && entry.h == h )
     {
-      n += num_nodes_rec( F.T, visited );
-      visited[F.T] = true;
+      ++num_cache_hit;
+      BDD_INSTRUMENT( ++instr.cache_hits[op]; )
+      r = entry.r;
+      return true;
     }
-    if ( !visited[F.E] )
+    ++num_cache_miss;
+    BDD_INSTRUMENT( ++instr.cache_misses[op]; )
+    return false;
+  }
+
+  /* Store the result of `op( f, g, h )` in the computed table.
+   * The table is lossy: whatever was stored in the same slot is overwritten. */
+  void cache_insert( uint32_t op, index_t f, index_t g, index_t h, index_t r )
+  {
+    Cache_Entry& entry = computed_table[cache_hash( op, f, g, h )];
+    if ( entry.op != OP_NONE && ( entry.op != op || entry.f != f || entry.g != g || entry.h != h ) )
     {
-      n += num_nodes_rec( F.E, visited );
-      visited[F.E] = true;
+      ++num_cache_eviction;
     }
-    return n + 1u;
+    entry.op = op;
+    entry.f = f;
+    entry.g = g;
+    entry.h = h;
+    entry.r = r;
   }
 
 private:
-  std::vector<Node> nodes;
-  std::vector<std::unordered_map<std::pair<index_t, index_t>, index_t>> unique_table;
-  /* `unique_table` is a vector of `num_vars` maps storing the built nodes of each variable.
-   * Each map maps from a pair of node indices (T, E) to a node index, if it exists.
+  Node_Store<Node, index_t> nodes; /* never moves the nodes when growing */
+  std::vector<index_t> free_list; /* indices of the node slots freed by garbage collection */
+  std::vector<uint32_t> var2level; /* level of each variable (and `num_vars` for the constants) */
+  std::vector<var_t> level2var; /* variable at each level */
+
+  std::vector<Subtable> unique_table;
+  /* `unique_table` is a vector of `num_vars` hash tables storing the built nodes of each variable.
+   * Each table finds the node with a given pair of edges (T, E), if it exists.
    * See the implementation of `unique` for example usage. */
 
+  std::vector<Subtable> zdd_table; /* the unique tables of the ZDD nodes, in the same format */
+  std::vector<Subtable> add_table; /* the unique tables of the non-terminal ADD nodes, in the same format */
+
+  /* The terminal value table of the ADDs (but 0 and 1, which are the constants): the value of a
+   * terminal node is `add_values[N.next]`, and `add_terminals` finds the terminal of a value.
+   * The slots of the collected terminals are on `add_free_values`. */
+  std::vector<double> add_values;
+  std::vector<index_t> add_free_values;
+  std::unordered_map<double, index_t> add_terminals;
+
+  std::vector<Apply_Frame> apply_stack; /* pending calls of `apply` */
+  std::vector<Compute_Frame> compute_stack; /* pending calls of `compute` */
+
+  std::vector<Cache_Entry> computed_table;
+  /* `computed_table` is a fixed-size, lossy hash table memoizing the results of the operations.
+   * Each entry is keyed by the operation code and its operands. See `cache_lookup` and `cache_insert`. */
+
   /* statistics */
-  uint64_t num_invoke_not, num_invoke_and, num_invoke_or, num_invoke_xor, num_invoke_ite;
+  uint64_t num_invoke_not, num_invoke_and, num_invoke_or, num_invoke_xor, num_invoke_ite, num_invoke_and_exists, num_invoke_compose;
+  uint64_t num_invoke_constrain, num_invoke_restrict, num_invoke_zdd, num_invoke_add, num_invoke_isop;
+  uint64_t num_cache_hit, num_cache_miss, num_cache_eviction;
+
+  uint64_t num_unique_lookup, num_unique_probe;
+
+  /* garbage collection */
+  uint64_t num_dead;
+  double gc_dead_ratio;
+  uint64_t gc_min_dead;
+  uint64_t num_gc, num_recycled;
+
+  /* reordering */
+  bool auto_reorder;
+  double max_growth;
+  uint64_t next_reorder;
+  uint64_t num_reorder, num_swap;
+
+#ifdef BDD_INSTRUMENTATION
+  /* instrumentation */
+  Instrumentation instr;
+  std::ostream* dump_stream;
+  double dump_period;
+  std::chrono::steady_clock::time_point last_dump;
+
+  /* Records the latency of an operation from its construction to its destruction. */
+  struct Latency_Timer
+  {
+    Latency_Timer( Basic_BDD& m, uint32_t op ) : m( m ), op( op ), start( std::chrono::steady_clock::now() ) {}
+
+    ~Latency_Timer()
+    {
+      uint64_t const ns = std::chrono::duration_cast<std::chrono::nanoseconds>( std::chrono::steady_clock::now() - start ).count();
+      uint32_t b = 0u;
+      while ( ( ns >> ( b + 1u ) ) != 0u && b + 1u < Instrumentation::num_latency_buckets )
+      {
+        ++b;
+      }
+      ++m.instr.latencies[op][b];
+    }
+
+    Basic_BDD& m;
+    uint32_t op;
+    std::chrono::steady_clock::time_point start;
+  };
+
+  /* Dump the instrumentation if the period set by `set_instrumentation_dump` has elapsed. */
+  void dump_if_due()
+  {
+    auto const now = std::chrono::steady_clock::now();
+    if ( dump_stream != nullptr && std::chrono::duration<double>( now - last_dump ).count() >= dump_period )
+    {
+      dump_instrumentation( *dump_stream );
+      last_dump = now;
+    }
+  }
+#endif
+
+  /* composition */
+  index_t composition_id; /* identifies the substitution of the last `vector_compose` in the computed table */
+
+  /* don't-care minimization */
+  uint64_t num_minimize, minimize_nodes_before, minimize_nodes_after;
+
+  /* parallel operations */
+  std::unique_ptr<Work_Stealing_Pool> pool; /* null when running single-threaded */
+  std::vector<Worker_Context> workers;
+  uint32_t max_spawn_depth;
+  std::mutex slot_mutex; /* protects `free_list` during a parallel operation */
+  std::atomic<bool> parallel_aborted;
+
+  /* memory limit */
+  uint64_t max_nodes, max_bytes;
+  bool limit_active; /* whether an operation is running under the limit (see `run_operation`) */
+  bool byte_limit_hit; /* whether the last `Memory_Limit_Exceeded` was due to `max_bytes` */
+  uint64_t num_memory_abort;
 };
+
+using BDD = Basic_BDD<uint32_t>;
+using BDD64 = Basic_BDD<uint64_t>;
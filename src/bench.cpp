@@ -0,0 +1,302 @@
+#include "BDD.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/* Benchmark suite of scalable BDD constructions.
+ * Usage: bdd_bench [--json | --csv] [--quick] [case ...]
+ *
+ * Runs each case (all of them by default) once in a fresh manager and reports its wall time,
+ * the peak number of nodes, `num_invoke()`, the computed table hit rate and the resident set
+ * size at the end of the case, in CSV (the default) or JSON. The generators are deterministic
+ * (random 3-SAT uses a fixed seed), so results can be compared across versions. `--quick`
+ * runs smaller instances, e.g., as a smoke test. The parallel operations and the bit-sliced
+ * evaluation have their own benchmarks (`bdd_parallel_bench` and `bdd_eval_bench`). */
+
+/* `f` is referenced; replace it with the (unreferenced) `g`, referencing it instead. */
+void update( BDD& bdd, uint32_t& f, uint32_t g )
+{
+  bdd.ref( g );
+  bdd.deref( f );
+  f = g;
+}
+
+/* The n-queens problem over the variables x_{i * n + j} (a queen on row i, column j):
+ * every row has a queen, and no two queens attack each other. */
+uint32_t queens( BDD& bdd, uint32_t n )
+{
+  auto const x = [&]( uint32_t i, uint32_t j ) { return bdd.literal( i * n + j ); };
+  uint32_t f = bdd.ref( bdd.constant( true ) );
+  for ( auto i = 0u; i < n; ++i )
+  {
+    uint32_t row = bdd.ref( bdd.constant( false ) );
+    for ( auto j = 0u; j < n; ++j )
+    {
+      update( bdd, row, bdd.OR( row, x( i, j ) ) );
+    }
+    update( bdd, f, bdd.AND( f, row ) );
+    bdd.deref( row );
+
+    for ( auto j = 0u; j < n; ++j )
+    {
+      /* A queen on ( i, j ) excludes the other cells of its column and diagonals on the rows below,
+       * and of its row. */
+      uint32_t free = bdd.ref( bdd.constant( true ) );
+      for ( auto k = 0u; k < n; ++k )
+      {
+        if ( k != j )
+        {
+          update( bdd, free, bdd.AND( free, bdd.NOT( x( i, k ) ) ) );
+        }
+      }
+      for ( auto l = i + 1u; l < n; ++l )
+      {
+        update( bdd, free, bdd.AND( free, bdd.NOT( x( l, j ) ) ) );
+        if ( j + l - i < n )
+        {
+          update( bdd, free, bdd.AND( free, bdd.NOT( x( l, j + l - i ) ) ) );
+        }
+        if ( j >= l - i )
+        {
+          update( bdd, free, bdd.AND( free, bdd.NOT( x( l, j - ( l - i ) ) ) ) );
+        }
+      }
+      update( bdd, f, bdd.AND( f, bdd.OR( bdd.NOT( x( i, j ) ), free ) ) );
+      bdd.deref( free );
+    }
+  }
+  return f;
+}
+
+/* The middle output bit of an n x n array multiplier, over a_i = x_{2i} and b_i = x_{2i+1}. */
+uint32_t multiplier( BDD& bdd, uint32_t n )
+{
+  vector<uint32_t> sum( 2u * n, bdd.constant( false ) );
+  for ( auto j = 0u; j < n; ++j )
+  {
+    uint32_t carry = bdd.constant( false );
+    for ( auto i = 0u; i + j < 2u * n - 1u && i < n; ++i )
+    {
+      uint32_t const p = bdd.ref( bdd.AND( bdd.literal( 2u * i ), bdd.literal( 2u * j + 1u ) ) );
+      uint32_t const s = sum[i + j];
+      uint32_t const t = bdd.ref( bdd.XOR( s, p ) );
+      uint32_t const next_sum = bdd.ref( bdd.XOR( t, carry ) );
+      uint32_t const g1 = bdd.ref( bdd.AND( s, p ) );
+      uint32_t const g2 = bdd.ref( bdd.AND( t, carry ) );
+      uint32_t const next_carry = bdd.ref( bdd.OR( g1, g2 ) );
+      for ( auto const g : {p, s, t, g1, g2, carry} )
+      {
+        bdd.deref( g );
+      }
+      sum[i + j] = next_sum;
+      carry = next_carry;
+    }
+    sum[j + n] = carry;
+  }
+  for ( auto i = 0u; i < 2u * n; ++i )
+  {
+    if ( i != n - 1u )
+    {
+      bdd.deref( sum[i] );
+    }
+  }
+  return sum[n - 1u];
+}
+
+/* The carry out of an n-bit adder in the worst variable order: a_0, ..., a_{n-1}, b_0, ..., b_{n-1}. */
+uint32_t adder( BDD& bdd, uint32_t n )
+{
+  uint32_t carry = bdd.ref( bdd.constant( false ) );
+  for ( auto i = 0u; i < n; ++i )
+  {
+    uint32_t const either = bdd.ref( bdd.OR( bdd.literal( i ), bdd.literal( n + i ) ) );
+    uint32_t const both = bdd.AND( bdd.literal( i ), bdd.literal( n + i ) );
+    update( bdd, carry, bdd.ITE( carry, either, both ) );
+    bdd.deref( either );
+  }
+  return carry;
+}
+
+/* The parity of n variables, adding each one below the previous ones. */
+uint32_t parity( BDD& bdd, uint32_t n )
+{
+  uint32_t f = bdd.ref( bdd.constant( false ) );
+  for ( auto i = 0u; i < n; ++i )
+  {
+    update( bdd, f, bdd.XOR( f, bdd.literal( i ) ) );
+  }
+  return f;
+}
+
+/* The hidden weighted bit function: x_{w - 1}, where w is the number of ones (0 if w = 0).
+ * It has exponential size in every variable order. */
+uint32_t hidden_weighted_bit( BDD& bdd, uint32_t n )
+{
+  /* exactly[k]: exactly k of the variables seen so far are 1 */
+  vector<uint32_t> exactly( n + 1u, bdd.constant( false ) );
+  exactly[0] = bdd.constant( true );
+  for ( auto i = 0u; i < n; ++i )
+  {
+    for ( auto k = i + 1u; k > 0u; --k )
+    {
+      uint32_t const next = bdd.ref( bdd.ITE( bdd.literal( i ), exactly[k - 1u], exactly[k] ) );
+      bdd.deref( exactly[k] );
+      exactly[k] = next;
+    }
+    update( bdd, exactly[0], bdd.AND( exactly[0], bdd.NOT( bdd.literal( i ) ) ) );
+  }
+  uint32_t f = bdd.ref( bdd.constant( false ) );
+  for ( auto k = 1u; k <= n; ++k )
+  {
+    update( bdd, f, bdd.OR( f, bdd.AND( exactly[k], bdd.literal( k - 1u ) ) ) );
+  }
+  for ( auto const g : exactly )
+  {
+    bdd.deref( g );
+  }
+  return f;
+}
+
+/* The conjunction of 3 * n random clauses of 3 distinct literals over n variables (a satisfiable
+ * ratio), with a fixed seed. */
+uint32_t random_3sat( BDD& bdd, uint32_t n )
+{
+  mt19937 rng( 2024u );
+  uint32_t f = bdd.ref( bdd.constant( true ) );
+  for ( auto c = 0u; c < 3u * n; ++c )
+  {
+    uint32_t vars[3];
+    bool complemented[3];
+    for ( auto i = 0u; i < 3u; ++i )
+    {
+      do
+      {
+        vars[i] = rng() % n;
+      } while ( ( i > 0u && vars[i] == vars[0] ) || ( i > 1u && vars[i] == vars[1] ) );
+      complemented[i] = rng() & 1u;
+    }
+    /* Only the operands of an operation are protected from garbage collection, so the literals
+     * are created right before the operation using them. */
+    uint32_t clause = bdd.OR( bdd.literal( vars[0], complemented[0] ), bdd.literal( vars[1], complemented[1] ) );
+    clause = bdd.OR( clause, bdd.literal( vars[2], complemented[2] ) );
+    update( bdd, f, bdd.AND( f, clause ) );
+  }
+  return f;
+}
+
+struct Case
+{
+  string name;
+  uint32_t size, quick_size; /* the scaling parameter */
+  function<uint32_t( uint32_t )> num_vars;
+  function<uint32_t( BDD&, uint32_t )> build;
+};
+
+struct Result
+{
+  string name;
+  uint32_t size;
+  double seconds;
+  uint64_t result_nodes, peak_nodes, invocations, cache_hits, cache_misses, gcs, rss_kb;
+};
+
+/* Resident set size of the process, in kB (0 if unknown). */
+uint64_t rss_kb()
+{
+  ifstream status( "/proc/self/status" );
+  string line;
+  while ( getline( status, line ) )
+  {
+    if ( line.compare( 0u, 6u, "VmRSS:" ) == 0 )
+    {
+      return strtoull( line.c_str() + 6, nullptr, 10 );
+    }
+  }
+  return 0u;
+}
+
+Result run( Case const& c, uint32_t size )
+{
+  BDD bdd( c.num_vars( size ), 1u << 20 );
+  auto const start = chrono::steady_clock::now();
+  uint32_t const f = c.build( bdd, size );
+  double const seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+  return Result( {c.name, size, seconds, bdd.num_nodes( f ), bdd.peak_num_nodes(), bdd.num_invoke(), bdd.num_cache_hits(),
+                  bdd.num_cache_misses(), bdd.num_garbage_collections(), rss_kb()} );
+}
+
+int main( int argc, char** argv )
+{
+  bool json = false, quick = false;
+  vector<string> selected;
+  for ( auto i = 1; i < argc; ++i )
+  {
+    string const arg = argv[i];
+    if ( arg == "--json" || arg == "--csv" )
+    {
+      json = arg == "--json";
+    }
+    else if ( arg == "--quick" )
+    {
+      quick = true;
+    }
+    else
+    {
+      selected.emplace_back( arg );
+    }
+  }
+
+  auto const same = []( uint32_t n ) { return n; };
+  auto const twice = []( uint32_t n ) { return 2u * n; };
+  vector<Case> const cases = {{"queens", 10u, 6u, []( uint32_t n ) { return n * n; }, queens},
+                              {"multiplier", 11u, 6u, twice, multiplier},
+                              {"adder", 16u, 8u, twice, adder},
+                              {"parity", 4000u, 200u, same, parity},
+                              {"hidden_weighted_bit", 34u, 10u, same, hidden_weighted_bit},
+                              {"random_3sat", 36u, 20u, same, random_3sat}};
+
+  vector<Result> results;
+  for ( auto const& c : cases )
+  {
+    if ( selected.empty() || find( selected.begin(), selected.end(), c.name ) != selected.end() )
+    {
+      results.emplace_back( run( c, quick ? c.quick_size : c.size ) );
+    }
+  }
+
+  if ( json )
+  {
+    cout << "{\n  \"compiler\": \"" << __VERSION__ << "\",\n  \"cases\": [\n";
+    for ( auto i = 0u; i < results.size(); ++i )
+    {
+      Result const& r = results[i];
+      uint64_t const lookups = r.cache_hits + r.cache_misses;
+      cout << "    {\"case\": \"" << r.name << "\", \"size\": " << r.size << ", \"seconds\": " << r.seconds
+           << ", \"result_nodes\": " << r.result_nodes << ", \"peak_nodes\": " << r.peak_nodes << ", \"num_invoke\": " << r.invocations
+           << ", \"cache_hits\": " << r.cache_hits << ", \"cache_misses\": " << r.cache_misses
+           << ", \"cache_hit_rate\": " << ( lookups == 0u ? 0.0 : double( r.cache_hits ) / lookups ) << ", \"garbage_collections\": " << r.gcs
+           << ", \"rss_kb\": " << r.rss_kb << "}" << ( i + 1u < results.size() ? "," : "" ) << "\n";
+    }
+    cout << "  ]\n}" << endl;
+  }
+  else
+  {
+    cout << "case,size,seconds,result_nodes,peak_nodes,num_invoke,cache_hits,cache_misses,cache_hit_rate,garbage_collections,rss_kb" << endl;
+    for ( auto const& r : results )
+    {
+      uint64_t const lookups = r.cache_hits + r.cache_misses;
+      cout << r.name << "," << r.size << "," << r.seconds << "," << r.result_nodes << "," << r.peak_nodes << "," << r.invocations << ","
+           << r.cache_hits << "," << r.cache_misses << "," << ( lookups == 0u ? 0.0 : double( r.cache_hits ) / lookups ) << "," << r.gcs
+           << "," << r.rss_kb << endl;
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,58 @@
+#include "BDD.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+/* Throughput of the bit-sliced evaluation.
+ * Usage: bdd_eval_bench [n [num_words]]
+ *
+ * Builds the n outputs of an n-bit adder's sum bits over 2n interleaved variables and evaluates
+ * them all on `num_words` words of random patterns, with 64 and 512 patterns per word. */
+
+template<typename Word>
+double run( BDD const& bdd, vector<uint32_t> const& roots, uint64_t num_words, double& seconds )
+{
+  mt19937_64 rng( 1u );
+  vector<Word> patterns( bdd.num_vars() * num_words );
+  for ( auto& word : patterns )
+  {
+    for ( auto i = 0u; i < sizeof( Word ) / 8u; ++i )
+    {
+      reinterpret_cast<uint64_t*>( &word )[i] = rng();
+    }
+  }
+  vector<Word> results( roots.size() * num_words );
+
+  auto const start = chrono::steady_clock::now();
+  bdd.evaluate( roots, patterns.data(), num_words, results.data() );
+  seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+  return num_words * sizeof( Word ) * 8u / seconds;
+}
+
+int main( int argc, char** argv )
+{
+  uint32_t const n = argc > 1 ? atoi( argv[1] ) : 32u;
+  uint64_t const num_words = argc > 2 ? atoll( argv[2] ) : 1u << 14;
+
+  BDD bdd( 2u * n );
+  vector<uint32_t> roots;
+  auto carry = bdd.constant( false );
+  for ( auto i = 0u; i < n; ++i )
+  {
+    auto const a = bdd.literal( 2u * i ), b = bdd.literal( 2u * i + 1u );
+    roots.emplace_back( bdd.ref( bdd.XOR( bdd.XOR( a, b ), carry ) ) );
+    carry = bdd.ref( bdd.OR( bdd.AND( a, b ), bdd.AND( carry, bdd.OR( a, b ) ) ) );
+  }
+  cout << n << " outputs, " << bdd.num_nodes() << " nodes" << endl;
+
+  double seconds;
+  double const narrow = run<uint64_t>( bdd, roots, num_words, seconds );
+  cout << "64 patterns per word: " << seconds << " s, " << narrow << " patterns/s" << endl;
+  double const wide = run<Word512>( bdd, roots, num_words / 8u, seconds );
+  cout << "512 patterns per word: " << seconds << " s, " << wide << " patterns/s" << endl;
+  return 0;
+}
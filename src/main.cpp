@@ -1,9 +1,15 @@
 #include "BDD.hpp"
+#include "netlist.hpp"
 #include "truth_table.hpp"
 
 #include <iostream>
 #include <string>
 #include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <sstream>
 
 using namespace std;
 
@@ -65,6 +71,20 @@ bool checkEQ( uint64_t actual, uint64_t expected )
   }
 }
 
+bool check( bool condition )
+{
+  if ( condition )
+  {
+    cout << "...passed." << endl;
+    return true;
+  }
+  else
+  {
+    cout << "...failed." << endl;
+    return false;
+  }
+}
+
 int main()
 {
   bool passed = true;
@@ -260,6 +280,903 @@ int main()
     passed &= checkLE( bdd.num_invoke(), 10 );
   }
 
+  {
+    cout << "test 09: garbage collection" << endl;
+    BDD bdd( 4 );
+    auto const x0 = bdd.ref( bdd.literal( 0 ) );
+    auto const x1 = bdd.ref( bdd.literal( 1 ) );
+    auto const x2 = bdd.ref( bdd.literal( 2 ) );
+    auto const x3 = bdd.ref( bdd.literal( 3 ) );
+
+    auto const g = bdd.ref( bdd.AND( bdd.OR( x0, x1 ), bdd.OR( x2, x3 ) ) );
+    auto const h = bdd.ref( bdd.XOR( x0, x3 ) );
+    bdd.deref( g );
+    bdd.deref( x0 ); bdd.deref( x1 ); bdd.deref( x2 ); bdd.deref( x3 );
+
+    cout << "  checking BDD size (living nodes)";
+    passed &= checkEQ( bdd.num_nodes(), 2 );
+    bdd.garbage_collect();
+    cout << "  checking number of dead nodes after collection";
+    passed &= checkEQ( bdd.num_dead_nodes(), 0 );
+
+    auto const f = bdd.ref( bdd.AND( h, bdd.literal( 1 ) ) );
+    auto const tt = bdd.get_tt( f );
+    passed &= check( tt, create_tt_nth_var( 4, 1 ) & ( create_tt_nth_var( 4, 0 ) ^ create_tt_nth_var( 4, 3 ) ) );
+    cout << "  checking reuse of collected nodes";
+    passed &= checkEQ( bdd.num_recycled_nodes() > 0, true );
+  }
+
+  {
+    cout << "test 10: variable reordering" << endl;
+    BDD bdd( 8 );
+    auto f = bdd.ref( bdd.constant( false ) );
+    for ( auto i = 0u; i < 4u; ++i )
+    {
+      auto const g = bdd.ref( bdd.OR( f, bdd.AND( bdd.literal( i ), bdd.literal( i + 4 ) ) ) );
+      bdd.deref( f );
+      f = g;
+    }
+    auto const tt = bdd.get_tt( f );
+    cout << "  checking BDD size before reordering";
+    passed &= checkEQ( bdd.num_nodes( f ), 30 );
+
+    bdd.reorder();
+    passed &= check( bdd.get_tt( f ), tt );
+    cout << "  checking BDD size after reordering";
+    passed &= checkEQ( bdd.num_nodes( f ), 8 );
+    cout << "  checking x0 and x4 are adjacent";
+    passed &= checkEQ( max( bdd.level_of( 0 ), bdd.level_of( 4 ) ) - min( bdd.level_of( 0 ), bdd.level_of( 4 ) ), 1 );
+  }
+
+  {
+    cout << "test 11: deep BDDs (no recursion on the call stack)" << endl;
+    uint32_t const n = 200000u;
+    BDD bdd( n );
+    auto p = bdd.ref( bdd.constant( false ) ); /* parity of all variables */
+    auto q = bdd.ref( bdd.constant( false ) ); /* parity of the even variables */
+    auto c = bdd.ref( bdd.constant( true ) ); /* conjunction of all variables */
+    auto all = bdd.zdd_base(); /* the single set of all variables */
+    for ( auto i = n; i-- > 0u; )
+    {
+      auto const x = bdd.ref( bdd.literal( i ) );
+      auto const p_next = bdd.ref( bdd.XOR( x, p ) );
+      auto const q_next = bdd.ref( i % 2 == 0 ? bdd.XOR( x, q ) : q );
+      auto const c_next = bdd.ref( bdd.AND( x, c ) );
+      bdd.deref( x ); bdd.deref( p ); bdd.deref( q ); bdd.deref( c );
+      p = p_next;
+      q = q_next;
+      c = c_next;
+      all = bdd.zdd_unique( i, all, bdd.zdd_empty() );
+    }
+    bdd.ref( all );
+
+    auto const f = bdd.ref( bdd.XOR( p, q ) ); /* parity of the odd variables */
+    cout << "  checking BDD size (reachable nodes)";
+    passed &= checkEQ( bdd.num_nodes( f ), n / 2 );
+    auto const g = bdd.ref( bdd.AND( f, q ) );
+    cout << "  checking (f | q) & ~(f ^ q) == f & q";
+    passed &= checkEQ( bdd.AND( bdd.OR( f, q ), bdd.NOT( p ) ), g );
+
+    auto const last = bdd.ref( bdd.literal( n - 1u ) );
+    cout << "  checking composition";
+    auto const positive = bdd.ref( bdd.cofactor( p, n - 1u, true ) );
+    auto const composed = bdd.ref( bdd.compose( p, n - 1u, bdd.literal( n - 2u ) ) );
+    passed &= check( bdd.XOR( positive, bdd.literal( n - 1u, true ) ) == p &&
+                     bdd.XOR( composed, bdd.XOR( bdd.literal( n - 2u ), last ) ) == p && bdd.swap_vars( p, 0u, n - 1u ) == p );
+    cout << "  checking generalized cofactors";
+    auto const restricted = bdd.ref( bdd.restrict( p, last ) );
+    passed &= check( restricted == positive && bdd.constrain( p, last ) == restricted );
+    cout << "  checking ZDDs";
+    auto const odd = bdd.ref( bdd.zdd_from_bdd( p ) ); /* the sets of odd size */
+    auto const even = bdd.ref( bdd.zdd_change( odd, n - 1u ) );
+    auto const both = bdd.ref( bdd.zdd_union( odd, even ) );
+    auto const quotient = bdd.ref( bdd.zdd_divide( odd, bdd.zdd_single( n - 1u ) ) );
+    auto const sets = bdd.zdd_sets( all );
+    passed &= check( bdd.zdd_to_bdd( odd ) == p && bdd.zdd_to_bdd( even ) == bdd.NOT( p ) &&
+                     bdd.zdd_intersection( odd, even ) == bdd.zdd_empty() && bdd.zdd_difference( both, even ) == odd &&
+                     bdd.zdd_subset1( odd, n - 1u ) == quotient && bdd.zdd_product( all, bdd.zdd_single( 0 ) ) == all &&
+                     bdd.zdd_count( all ) == 1.0l && sets.size() == 1u && sets[0].size() == n );
+    cout << "  checking ADDs";
+    auto const parity = bdd.ref( bdd.add_from_bdd( p ) );
+    auto const twice = bdd.ref( bdd.add_plus( parity, parity ) );
+    passed &= check( bdd.add_to_bdd( twice, 2.0 ) == p && bdd.add_sum_abstract( parity, last ) == bdd.constant( true ) &&
+                     bdd.add_max_abstract( twice, last ) == bdd.add_constant( 2.0 ) );
+    cout << "  checking ISOP";
+    auto const cubes = bdd.isop_cubes( c, c );
+    passed &= check( bdd.isop( c, c ) == c && bdd.isop_num_cubes( c, c ) == 1u && cubes.size() == 1u &&
+                     std::count( cubes[0].begin(), cubes[0].end(), 1 ) == std::ptrdiff_t( n ) );
+  }
+
+  {
+    cout << "test 12: parallel operations" << endl;
+    BDD bdd( 24 );
+    auto const build = [&]() { /* OR of x_i & x_{i+12}, a large BDD in this order */
+      auto f = bdd.ref( bdd.constant( false ) );
+      for ( auto i = 0u; i < 12u; ++i )
+      {
+        auto const g = bdd.ref( bdd.OR( f, bdd.AND( bdd.literal( i ), bdd.literal( i + 12u ) ) ) );
+        bdd.deref( f );
+        f = g;
+      }
+      return f;
+    };
+    auto const serial = build();
+    auto const serial_ite = bdd.ref( bdd.ITE( bdd.literal( 3 ), serial, bdd.XOR( serial, bdd.literal( 20 ) ) ) );
+    bdd.resize_cache( bdd.cache_size() ); /* clear it */
+
+    bdd.set_num_threads( 4u, 4u );
+    cout << "  checking number of threads";
+    passed &= checkEQ( bdd.num_threads(), 4u );
+    auto const parallel = build();
+    auto const parallel_ite = bdd.ITE( bdd.literal( 3 ), parallel, bdd.XOR( parallel, bdd.literal( 20 ) ) );
+    cout << "  checking OR/AND results equal to the single-threaded ones";
+    passed &= checkEQ( parallel, serial );
+    cout << "  checking ITE/XOR results equal to the single-threaded ones";
+    passed &= checkEQ( parallel_ite, serial_ite );
+  }
+
+  {
+    cout << "test 13: 64-bit indices" << endl;
+    BDD bdd( 16 );
+    BDD64 bdd64( 16 );
+    auto f = bdd.constant( false );
+    auto f64 = bdd64.constant( false );
+    for ( auto i = 0u; i < 8u; ++i )
+    {
+      f = bdd.OR( f, bdd.AND( bdd.literal( i ), bdd.literal( i + 8u ) ) );
+      f64 = bdd64.OR( f64, bdd64.AND( bdd64.literal( i ), bdd64.literal( i + 8u ) ) );
+    }
+    cout << "  checking BDD size (reachable nodes)";
+    passed &= checkEQ( bdd64.num_nodes( f64 ), bdd.num_nodes( f ) );
+    passed &= check( bdd64.get_tt( f64 ), bdd.get_tt( f ) );
+  }
+
+  {
+    cout << "test 14: quantification" << endl;
+    BDD bdd( 5 );
+    auto const x0 = bdd.literal( 0 ), x1 = bdd.literal( 1 ), x2 = bdd.literal( 2 ), x3 = bdd.literal( 3 ), x4 = bdd.literal( 4 );
+    auto const f = bdd.ref( bdd.OR( bdd.AND( x0, bdd.XOR( x1, x3 ) ), bdd.ITE( x2, x4, bdd.NOT( x3 ) ) ) );
+    auto const g = bdd.ref( bdd.OR( bdd.XOR( x1, x4 ), bdd.AND( bdd.NOT( x0 ), x3 ) ) );
+    auto const cube = bdd.ref( bdd.AND( x1, x3 ) );
+    auto const tt = bdd.get_tt( f );
+
+    passed &= check( bdd.get_tt( bdd.exists( f, cube ) ), tt.smoothing( 1 ).smoothing( 3 ) );
+    passed &= check( bdd.get_tt( bdd.forall( f, cube ) ), tt.consensus( 1 ).consensus( 3 ) );
+    cout << "  checking and_exists( f, g ) == exists( f & g )";
+    passed &= checkEQ( bdd.and_exists( f, g, cube ), bdd.exists( bdd.AND( f, g ), cube ) );
+    cout << "  checking exists over no variable";
+    passed &= checkEQ( bdd.exists( f, bdd.constant( true ) ), f );
+    bdd.reorder_window( 3 );
+    passed &= check( bdd.get_tt( bdd.and_exists( f, g, cube ) ), ( bdd.get_tt( f ) & bdd.get_tt( g ) ).smoothing( 1 ).smoothing( 3 ) );
+  }
+
+  {
+    cout << "test 15: truth table cofactors" << endl;
+    auto const x = [&]( uint8_t var ) { return create_tt_nth_var( 8, var ); };
+    auto const f = ( x( 1 ) & x( 7 ) ) | ( x( 3 ) ^ x( 6 ) );
+    passed &= check( f.positive_cofactor( 7 ), x( 1 ) | ( x( 3 ) ^ x( 6 ) ) );
+    passed &= check( f.negative_cofactor( 7 ), x( 3 ) ^ x( 6 ) );
+    passed &= check( f.positive_cofactor( 1 ), x( 7 ) | ( x( 3 ) ^ x( 6 ) ) );
+    passed &= check( f.negative_cofactor( 6 ), ( x( 1 ) & x( 7 ) ) | x( 3 ) );
+    passed &= check( f.derivative( 3 ), ~( x( 1 ) & x( 7 ) ) );
+  }
+
+  {
+    cout << "test 16: vectorized truth table kernels" << endl;
+    auto const x = [&]( uint8_t var ) { return create_tt_nth_var( 12, var ); };
+    auto const f = ( x( 2 ) & ~x( 11 ) ) | ( x( 5 ) ^ x( 8 ) ^ x( 9 ) );
+    auto const g = x( 0 ) | ( x( 7 ) & x( 10 ) );
+    for ( auto const level : {Simd_Level::scalar, Simd_Level::sse2, Simd_Level::avx2, Simd_Level::avx512} )
+    {
+      if ( !set_simd_level( level ) )
+      {
+        continue;
+      }
+      Truth_Table h( 12 );
+      h |= f;
+      h &= g;
+      h ^= x( 4 );
+      passed &= check( h, ( f & g ) ^ x( 4 ) );
+      passed &= check( f.negative_cofactor( 3 ).positive_cofactor( 9 ), ( x( 2 ) & ~x( 11 ) ) | ~( x( 5 ) ^ x( 8 ) ) );
+      cout << "  checking number of ones";
+      passed &= checkEQ( ( x( 3 ) & x( 6 ) & ~x( 9 ) ).count_ones(), 512 );
+    }
+    set_simd_level( best_simd_level() );
+  }
+
+  {
+    cout << "test 17: truth tables of large BDDs" << endl;
+    BDD bdd( 20 );
+    auto f = bdd.ref( bdd.constant( false ) ); /* OR of x_i & x_{i+10} */
+    for ( auto i = 0u; i < 10u; ++i )
+    {
+      auto const g = bdd.ref( bdd.OR( f, bdd.AND( bdd.literal( i ), bdd.literal( i + 10u ) ) ) );
+      bdd.deref( f );
+      f = g;
+    }
+    Truth_Table expected( 20 );
+    for ( auto i = 0u; i < 10u; ++i )
+    {
+      expected |= create_tt_nth_var( 20, i ) & create_tt_nth_var( 20, i + 10u );
+    }
+    passed &= check( bdd.get_tt( f ), expected );
+    cout << "  checking number of ones";
+    passed &= checkEQ( bdd.get_tt( bdd.NOT( f ) ).count_ones(), 59049 ); /* 3^10 */
+
+    bdd.reorder();
+    std::vector<uint64_t> words( Truth_Table::num_words( 20 ) );
+    bdd.get_tt( f, words.data() );
+    passed &= check( Truth_Table( 20, std::move( words ) ), expected );
+  }
+
+  {
+    cout << "test 18: BDDs from truth tables" << endl;
+    BDD bdd( 20 );
+    auto const x = [&]( uint8_t var ) { return create_tt_nth_var( 20, var ); };
+    auto const tt = ( x( 0 ) & x( 13 ) ) | ( x( 4 ) ^ x( 19 ) ^ x( 7 ) ) | ( ~x( 2 ) & x( 11 ) & x( 15 ) );
+    auto const f = bdd.ref( bdd.from_tt( tt ) );
+    passed &= check( bdd.get_tt( f ), tt );
+    cout << "  checking canonicity";
+    auto const g = bdd.OR( bdd.OR( bdd.AND( bdd.literal( 0 ), bdd.literal( 13 ) ), bdd.XOR( bdd.XOR( bdd.literal( 4 ), bdd.literal( 19 ) ), bdd.literal( 7 ) ) ),
+                           bdd.AND( bdd.AND( bdd.literal( 2, true ), bdd.literal( 11 ) ), bdd.literal( 15 ) ) );
+    passed &= checkEQ( f, g );
+
+    bdd.reorder();
+    cout << "  checking canonicity after reordering";
+    passed &= checkEQ( bdd.from_tt( tt ), f );
+  }
+
+  {
+    cout << "test 19: satisfying assignments" << endl;
+    BDD bdd( 8 );
+    auto const x = [&]( uint8_t var ) { return create_tt_nth_var( 8, var ); };
+    auto const tt = ( x( 0 ) & x( 5 ) ) | ( x( 1 ) ^ x( 6 ) ^ x( 3 ) );
+    auto const f = bdd.ref( bdd.from_tt( tt ) );
+    cout << "  checking number of solutions";
+    passed &= checkEQ( uint64_t( bdd.sat_count( f ) ), tt.count_ones() );
+    cout << "  checking exact number of solutions of disjunctions";
+    BDD small( 5 ), wide( 60 );
+    auto const small_or = small.OR( small.OR( small.literal( 0 ), small.literal( 1 ) ), small.literal( 2 ) );
+    auto const wide_or = wide.OR( wide.literal( 0 ), wide.literal( 1 ) );
+    passed &= check( uint64_t( small.sat_count( small_or ) ) == 28u && uint64_t( wide.sat_count( wide_or ) ) == 3u * ( uint64_t( 1 ) << 58 ) );
+
+    auto const to_position = []( std::vector<int8_t> const& cube ) {
+      uint64_t position = 0u;
+      for ( auto v = 0u; v < cube.size(); ++v )
+      {
+        position |= uint64_t( cube[v] == 1 ) << v;
+      }
+      return position;
+    };
+    cout << "  checking any_sat";
+    passed &= check( tt.get_bit( to_position( bdd.any_sat( f ) ) ) && bdd.any_sat( bdd.constant( false ) ).empty() );
+
+    uint64_t num_minterms = 0u, num_covered = 0u;
+    bool all_solutions = true;
+    for ( auto const& minterm : bdd.minterms( f ) )
+    {
+      all_solutions &= tt.get_bit( to_position( minterm ) );
+      ++num_minterms;
+    }
+    for ( auto const& cube : bdd.cubes( f ) )
+    {
+      num_covered += uint64_t( 1u ) << std::count( cube.begin(), cube.end(), -1 );
+    }
+    cout << "  checking enumerated minterms";
+    passed &= check( all_solutions && num_minterms == tt.count_ones() && num_covered == tt.count_ones() );
+
+    std::mt19937 rng( 1u );
+    bool all_samples = true;
+    for ( auto const& sample : bdd.sample_sat( f, 100u, rng ) )
+    {
+      all_samples &= tt.get_bit( to_position( std::vector<int8_t>( sample.begin(), sample.end() ) ) );
+    }
+    cout << "  checking sampled solutions";
+    passed &= check( all_samples );
+
+    BDD large( 2000 );
+    auto g = large.constant( true ); /* a single minterm */
+    for ( auto v = 2000u; v-- > 0u; )
+    {
+      g = large.AND( g, large.literal( v, v % 2 == 0 ) );
+    }
+    cout << "  checking number of solutions in the logarithmic domain";
+    passed &= check( large.log2_sat_count( g ) == 0.0 && std::abs( large.log2_sat_count( large.NOT( g ) ) - 2000.0 ) < 1e-9 );
+  }
+
+  {
+    cout << "test 20: bit-sliced evaluation" << endl;
+    BDD bdd( 8 );
+    auto const f = bdd.ref( bdd.OR( bdd.AND( bdd.literal( 0 ), bdd.literal( 5, true ) ), bdd.XOR( bdd.literal( 1 ), bdd.ITE( bdd.literal( 7 ), bdd.literal( 3 ), bdd.literal( 2 ) ) ) ) );
+    auto const g = bdd.ref( bdd.XOR( f, bdd.AND( bdd.literal( 4 ), bdd.literal( 6 ) ) ) );
+    auto const tt_f = bdd.get_tt( f );
+    auto const tt_g = bdd.get_tt( g );
+
+    /* all 256 assignments, 64 per word; pattern p assigns bit v of p to variable v */
+    std::vector<uint64_t> patterns( 8u * 4u );
+    for ( auto p = 0u; p < 256u; ++p )
+    {
+      for ( auto v = 0u; v < 8u; ++v )
+      {
+        patterns[v * 4u + p / 64u] |= uint64_t( ( p >> v ) & 1u ) << ( p % 64u );
+      }
+    }
+    cout << "  checking evaluation of a single output";
+    passed &= check( bdd.evaluate( f, patterns ) == tt_f.bits );
+
+    /* 512 patterns per word: the 256 assignments twice */
+    std::vector<Word512> wide( 8u );
+    for ( auto v = 0u; v < 8u; ++v )
+    {
+      for ( auto i = 0u; i < 8u; ++i )
+      {
+        wide[v].w[i] = patterns[v * 4u + i % 4u];
+      }
+    }
+    Word512 results[3];
+    bdd.evaluate( std::vector<uint32_t>( {f, g, bdd.NOT( g )} ), wide.data(), 1u, results );
+    bool all_outputs = true;
+    for ( auto i = 0u; i < 8u; ++i )
+    {
+      all_outputs &= results[0].w[i] == tt_f.bits[i % 4u] && results[1].w[i] == tt_g.bits[i % 4u] && results[2].w[i] == ~tt_g.bits[i % 4u];
+    }
+    cout << "  checking evaluation of several outputs in one pass";
+    passed &= check( all_outputs );
+  }
+
+  {
+    cout << "test 21: composition and substitution" << endl;
+    BDD bdd( 6 );
+    auto const x = [&]( uint8_t var ) { return create_tt_nth_var( 6, var ); };
+    auto const tt_f = ( x( 0 ) & x( 3 ) ) | ( x( 1 ) ^ x( 4 ) ^ x( 5 ) );
+    auto const tt_g = x( 2 ) ^ ( x( 0 ) | x( 5 ) );
+    auto const tt_h = ~x( 1 ) & x( 3 );
+    auto const f = bdd.ref( bdd.from_tt( tt_f ) );
+    auto const g = bdd.ref( bdd.from_tt( tt_g ) );
+    auto const h = bdd.ref( bdd.from_tt( tt_h ) );
+
+    cout << "  checking cofactors";
+    passed &= check( bdd.get_tt( bdd.cofactor( f, 4, true ) ) == tt_f.positive_cofactor( 4 ) &&
+                     bdd.get_tt( bdd.cofactor( bdd.NOT( f ), 0, false ) ) == ~tt_f.negative_cofactor( 0 ) );
+
+    cout << "  checking composition";
+    auto const composed = ( tt_g & tt_f.positive_cofactor( 4 ) ) | ( ~tt_g & tt_f.negative_cofactor( 4 ) );
+    passed &= check( bdd.get_tt( bdd.compose( f, 4, g ) ) == composed );
+
+    /* f( x_0, x_1 := g, x_2, x_3, x_4 := h, x_5 ), substituted simultaneously */
+    cout << "  checking vector composition";
+    std::vector<uint32_t> substitution;
+    for ( auto v = 0u; v < 6u; ++v )
+    {
+      substitution.emplace_back( bdd.literal( v ) );
+    }
+    substitution[1] = g;
+    substitution[4] = h;
+    auto const tt_vc = ( x( 0 ) & x( 3 ) ) | ( tt_g ^ tt_h ^ x( 5 ) );
+    passed &= check( bdd.get_tt( bdd.vector_compose( f, substitution ) ) == tt_vc );
+
+    cout << "  checking permutation";
+    Truth_Table tt_swapped = tt_f;
+    tt_swapped.swap_vars( 0, 4 );
+    tt_swapped.swap_vars( 3, 5 );
+    passed &= check( bdd.get_tt( bdd.permute( f, {4, 1, 2, 5, 0, 3} ) ) == tt_swapped );
+    cout << "  checking variable swapping";
+    Truth_Table tt_swapped2 = tt_f;
+    tt_swapped2.swap_vars( 1, 3 );
+    passed &= check( bdd.get_tt( bdd.swap_vars( f, 1, 3 ) ) == tt_swapped2 );
+  }
+
+  {
+    cout << "test 22: don't-care minimization" << endl;
+    BDD bdd( 8 );
+    auto const x = [&]( uint8_t var ) { return create_tt_nth_var( 8, var ); };
+    auto const tt_f = ( x( 0 ) & x( 3 ) & x( 6 ) ) | ( x( 1 ) ^ x( 4 ) ^ x( 7 ) ) | ( x( 2 ) & ~x( 5 ) );
+    auto const tt_c = x( 1 ) & ( x( 4 ) | ~x( 3 ) );
+    auto const f = bdd.ref( bdd.from_tt( tt_f ) );
+    auto const c = bdd.ref( bdd.from_tt( tt_c ) );
+
+    auto const constrained = bdd.ref( bdd.constrain( f, c ) );
+    auto const restricted = bdd.ref( bdd.restrict( f, c ) );
+    auto const minimized = bdd.ref( bdd.minimize( f, c ) );
+    cout << "  checking agreement on the care set";
+    passed &= check( ( bdd.get_tt( constrained ) & tt_c ) == ( tt_f & tt_c ) && ( bdd.get_tt( restricted ) & tt_c ) == ( tt_f & tt_c ) &&
+                     ( bdd.get_tt( minimized ) & tt_c ) == ( tt_f & tt_c ) );
+
+    cout << "  checking that constrain distributes over AND";
+    auto const g = bdd.ref( bdd.XOR( bdd.literal( 3 ), bdd.literal( 5 ) ) );
+    auto const lhs = bdd.ref( bdd.constrain( bdd.AND( f, g ), c ) );
+    passed &= checkEQ( bdd.AND( constrained, bdd.ref( bdd.constrain( g, c ) ) ), lhs );
+
+    cout << "  checking that restrict does not add variables";
+    bool support_kept = true;
+    for ( auto v = 0u; v < 8u; ++v )
+    {
+      support_kept &= tt_f.positive_cofactor( v ) != tt_f.negative_cofactor( v ) ||
+                      bdd.cofactor( restricted, v, true ) == bdd.cofactor( restricted, v, false );
+    }
+    passed &= check( support_kept );
+
+    cout << "  checking node reduction";
+    passed &= check( bdd.num_nodes( minimized ) < bdd.num_nodes( f ) && bdd.num_minimize_calls() == 1u &&
+                     bdd.num_minimized_nodes() == std::make_pair( bdd.num_nodes( f ), bdd.num_nodes( minimized ) ) );
+  }
+
+  {
+    cout << "test 23: serialization" << endl;
+    BDD bdd( 12 );
+    auto const x = [&]( uint8_t var ) { return create_tt_nth_var( 12, var ); };
+    auto const tt_f = ( x( 0 ) & x( 7 ) ) | ( x( 2 ) ^ x( 9 ) ^ x( 11 ) ) | ( ~x( 3 ) & x( 5 ) );
+    auto const tt_g = ( x( 1 ) | x( 4 ) ) & ~( x( 6 ) ^ x( 10 ) );
+    auto const f = bdd.ref( bdd.from_tt( tt_f ) );
+    auto const g = bdd.ref( bdd.from_tt( tt_g ) );
+    std::stringstream buffer;
+    bdd.save( buffer, {{"f", f}, {"not g", bdd.NOT( g )}} );
+    std::string const data = buffer.str();
+    auto const load = [&]( BDD& manager ) { return manager.load( reinterpret_cast<uint8_t const*>( data.data() ), data.size() ); };
+    auto const loaded_correctly = [&]( BDD& manager, BDD::Named_Roots const& roots ) {
+      return roots.size() == 2u && roots[0].first == "f" && roots[1].first == "not g" &&
+             manager.get_tt( roots[0].second ) == tt_f && manager.get_tt( roots[1].second ) == ~tt_g;
+    };
+
+    BDD fresh( 12 );
+    auto const roots = load( fresh );
+    cout << "  checking loading into an empty manager";
+    passed &= check( loaded_correctly( fresh, roots ) );
+    cout << "  checking canonicity of the loaded nodes";
+    uint64_t const size = fresh.num_nodes();
+    passed &= check( fresh.from_tt( tt_f ) == roots[0].second && fresh.from_tt( ~tt_g ) == roots[1].second && fresh.num_nodes() == size );
+
+    BDD used( 12 );
+    auto const h = used.ref( used.XOR( used.literal( 2 ), used.literal( 9 ) ) );
+    cout << "  checking loading into a non-empty manager";
+    passed &= check( loaded_correctly( used, load( used ) ) && used.get_tt( h ) == ( x( 2 ) ^ x( 9 ) ) );
+
+    BDD reordered( 12 );
+    reordered.swap_levels( 0 );
+    reordered.swap_levels( 5 );
+    cout << "  checking loading with another variable order";
+    passed &= check( loaded_correctly( reordered, load( reordered ) ) );
+
+    cout << "  checking a file mapped into memory";
+    bdd.save( "test_bdd.bin", {{"f", f}, {"not g", bdd.NOT( g )}} );
+    BDD mapped( 12 );
+    passed &= check( loaded_correctly( mapped, mapped.load( "test_bdd.bin" ) ) );
+    std::remove( "test_bdd.bin" );
+
+    cout << "  checking rejection of truncated data";
+    bool rejected = false;
+    try
+    {
+      BDD other( 12 );
+      other.load( reinterpret_cast<uint8_t const*>( data.data() ), data.size() - 3u );
+    }
+    catch ( std::runtime_error const& )
+    {
+      rejected = true;
+    }
+    passed &= check( rejected );
+
+    /* the literal x_1, then twice the node x_0 ? x_1 : 1, as roots "a" and "b" */
+    std::string const duplicate( "BDD\x1a\x01\x02\x00\x01\x01\x01\x03\x02\x01\x04\x02\x06\x02\x01"
+                                 "a\x04\x01"
+                                 "b\x06",
+                                 23u );
+    BDD crafted( 2 );
+    crafted.set_memory_limit( 2u );
+    cout << "  checking rejection of duplicate nodes (and no memory limit afterwards)";
+    bool duplicate_rejected = false;
+    try
+    {
+      crafted.load( reinterpret_cast<uint8_t const*>( duplicate.data() ), duplicate.size() );
+    }
+    catch ( std::runtime_error const& )
+    {
+      duplicate_rejected = true;
+    }
+    passed &= check( duplicate_rejected && crafted.literal( 0 ) != crafted.literal( 1 ) );
+
+    BDD limited( 12 );
+    limited.set_memory_limit( 4u );
+    cout << "  checking the memory limit";
+    bool limit_hit = false;
+    try
+    {
+      load( limited );
+    }
+    catch ( Memory_Limit_Exceeded const& )
+    {
+      limit_hit = true;
+    }
+    limited.set_memory_limit( 1u << 20 );
+    passed &= check( limit_hit && loaded_correctly( limited, load( limited ) ) );
+  }
+
+  {
+    cout << "test 24: reading netlists" << endl;
+    BDD bdd( 4 );
+    auto const a = bdd.literal( 0 ), b = bdd.literal( 1 ), c = bdd.literal( 2 );
+    auto const x = bdd.ref( bdd.XOR( a, b ) );
+    auto const y = bdd.ref( bdd.AND( x, c ) );
+
+    /* x = a ^ b and y = x & c, with the AND gates out of order */
+    std::istringstream aag( "aag 7 3 0 2 4\n2\n4\n6\n13\n14\n14 13 6\n8 2 5\n10 3 4\n12 9 11\ni0 a\no1 y\nc\ncomment\n" );
+    Netlist const from_aag = read_aiger( aag );
+    auto const aag_outputs = build_bdds( bdd, from_aag );
+    cout << "  checking ASCII AIGER";
+    passed &= check( aag_outputs == std::vector<uint32_t>( {x, y} ) && from_aag.inputs[0] == "a" && from_aag.outputs[1] == "y" );
+
+    std::istringstream aig( std::string( "aig 7 3 0 2 4\n13\n14\n\x03\x03\x06\x01\x01\x02\x01\x07" ) );
+    cout << "  checking binary AIGER";
+    passed &= check( build_bdds( bdd, read_aiger( aig ) ) == std::vector<uint32_t>( {x, y} ) );
+
+    /* the same, with x = ~( a & b ) given by its off-set and a latch storing y */
+    std::istringstream blif( ".model test\n.inputs a b \\\n c\n.outputs x y\n.latch y q 0\n.names t c y\n11 1\n"
+                             ".names a b t # t = a ^ b\n10 1\n01 1\n.names a b x\n11 0\n.end\n" );
+    Netlist const from_blif = read_blif( blif );
+    Netlist_Stats stats;
+    cout << "  checking BLIF";
+    passed &= check( build_bdds( bdd, from_blif, &stats ) == std::vector<uint32_t>( {bdd.NOT( bdd.AND( a, b ) ), y, y} ) &&
+                     from_blif.inputs.size() == 4u && from_blif.inputs[3] == "q" && stats.outputs.size() == 3u &&
+                     stats.outputs[1].nodes == bdd.num_nodes( y ) && stats.peak_live_nodes >= bdd.num_nodes( y ) );
+
+    std::istringstream pla( ".i 3\n.o 2\n.ilb a b c\n.ob x y\n.p 2\n1-0 10\n-11 11\n.e\n" );
+    cout << "  checking PLA";
+    passed &= check( build_bdds( bdd, read_pla( pla ) ) == std::vector<uint32_t>( {bdd.OR( bdd.AND( a, bdd.NOT( c ) ), bdd.AND( b, c ) ), bdd.AND( b, c )} ) );
+
+    cout << "  checking rejection of combinational cycles";
+    std::istringstream cyclic( ".model cycle\n.inputs a\n.outputs y\n.names a z y\n11 1\n.names y z\n0 1\n.end\n" );
+    bool rejected = false;
+    try
+    {
+      build_bdds( bdd, read_blif( cyclic ) );
+    }
+    catch ( std::runtime_error const& )
+    {
+      rejected = true;
+    }
+    passed &= check( rejected );
+  }
+
+#ifdef BDD_INSTRUMENTATION
+  {
+    cout << "test 25: instrumentation" << endl;
+    BDD bdd( 16 );
+    auto f = bdd.ref( bdd.constant( false ) );
+    for ( auto i = 0u; i < 8u; ++i )
+    {
+      auto const g = bdd.ref( bdd.OR( f, bdd.AND( bdd.literal( i ), bdd.literal( i + 8u ) ) ) );
+      bdd.deref( f );
+      f = g;
+    }
+    bdd.garbage_collect();
+    auto const& stats = bdd.instrumentation();
+
+    cout << "  checking counters";
+    uint64_t lookups = 0u, probes = 0u, collisions = 0u, calls = 0u;
+    for ( auto l = 0u; l < 16u; ++l )
+    {
+      lookups += stats.unique_lookups[l];
+      probes += stats.unique_probes[l];
+      collisions += stats.unique_collisions[l];
+    }
+    for ( auto const count : stats.latencies[1] ) /* AND */
+    {
+      calls += count;
+    }
+    passed &= check( lookups >= stats.allocated_nodes && collisions <= probes && calls == 8u &&
+                     stats.cache_hits[1] + stats.cache_misses[1] > 0u && std::string( BDD::op_name( 1 ) ) == "and" &&
+                     stats.peak_live_nodes >= bdd.num_nodes( f ) && stats.allocated_nodes == bdd.peak_num_nodes() && stats.num_gc == 1u );
+
+    /* The dump at the beginning of the AND precedes the recording of its latency. */
+    cout << "  checking periodic dumps";
+    std::ostringstream dumps;
+    bdd.set_instrumentation_dump( &dumps, 0.0 );
+    bdd.AND( f, bdd.literal( 3 ) );
+    passed &= check( dumps.str().find( "and: 8 calls" ) != std::string::npos );
+
+    cout << "  checking ZDD lookups (per variable, apart from the BDD levels)";
+    bdd.set_instrumentation_dump( nullptr, 0.0 );
+    bdd.swap_levels( 0 );
+    uint64_t const bdd_lookups = std::accumulate( stats.unique_lookups.begin(), stats.unique_lookups.end(), uint64_t( 0u ) );
+    bdd.zdd_single( 0 );
+    passed &= check( stats.diagram_lookups[0] == 1u && stats.diagram_lookups[1] == 0u &&
+                     std::accumulate( stats.unique_lookups.begin(), stats.unique_lookups.end(), uint64_t( 0u ) ) == bdd_lookups );
+  }
+#endif
+
+  {
+    cout << "test 26: memory budget" << endl;
+    /* The carry out of a 12-bit adder in the worst order needs thousands of nodes. */
+    auto const adder = []( BDD& bdd, uint32_t& carry, uint32_t& i, uint32_t offset ) {
+      for ( ; i < 12u; ++i )
+      {
+        auto const either = bdd.ref( bdd.OR( bdd.literal( offset + i ), bdd.literal( offset + 12u + i ) ) );
+        auto const both = bdd.ref( bdd.AND( bdd.literal( offset + i ), bdd.literal( offset + 12u + i ) ) );
+        auto const next = bdd.ref( bdd.ITE( carry, either, both ) );
+        bdd.deref( carry );
+        bdd.deref( either );
+        bdd.deref( both );
+        carry = next;
+      }
+    };
+    BDD unlimited( 24 );
+    uint32_t expected = unlimited.constant( false ), j = 0u;
+    adder( unlimited, expected, j, 0u );
+
+    BDD bdd( 24 );
+    bdd.set_memory_limit( 1000u );
+    uint32_t carry = bdd.constant( false ), i = 0u;
+    bool thrown = false;
+    try
+    {
+      adder( bdd, carry, i, 0u );
+    }
+    catch ( Memory_Limit_Exceeded const& )
+    {
+      thrown = true;
+    }
+    cout << "  checking that a runaway operation is aborted";
+    passed &= check( thrown && i < 12u && bdd.num_memory_aborts() == 1u && bdd.peak_num_nodes() <= 1000u );
+
+    cout << "  checking that the manager is still consistent";
+    uint64_t const size = bdd.num_nodes( carry );
+    bdd.garbage_collect();
+    passed &= check( bdd.num_nodes( carry ) == size && bdd.num_live_nodes() == bdd.num_nodes() );
+
+    cout << "  checking resuming after raising the limit";
+    bdd.set_memory_limit( 1u << 20 );
+    adder( bdd, carry, i, 0u );
+    passed &= check( bdd.num_nodes( carry ) == unlimited.num_nodes( expected ) && bdd.sat_count( carry ) == unlimited.sat_count( expected ) );
+
+    /* Without automatic garbage collection, the operations only fit by recycling the dead nodes. */
+    cout << "  checking that garbage collection makes room";
+    BDD small( 26 );
+    small.set_gc_threshold( 1.0, 1u << 30 );
+    uint32_t first = small.constant( false ), k = 0u;
+    adder( small, first, k, 0u );
+    small.deref( first );
+    small.set_memory_limit( small.peak_num_nodes() );
+    uint32_t second = small.constant( false ), l = 0u;
+    adder( small, second, l, 2u );
+    passed &= check( small.num_memory_aborts() == 0u && small.num_garbage_collections() > 0u && small.num_nodes( second ) == unlimited.num_nodes( expected ) );
+
+    /* The computed table is shrunk as far as possible before giving up. */
+    cout << "  checking the byte limit";
+    BDD tight( 24, 1u << 16 );
+    tight.set_memory_limit( 1u << 20, tight.memory_usage() / 4u );
+    uint32_t third = tight.constant( false ), m = 0u;
+    thrown = false;
+    try
+    {
+      adder( tight, third, m, 0u );
+    }
+    catch ( Memory_Limit_Exceeded const& )
+    {
+      thrown = true;
+    }
+    passed &= check( thrown && tight.cache_size() == ( 1u << 10 ) && tight.peak_num_nodes() < 1024u );
+  }
+
+  {
+    cout << "test 27: zero-suppressed decision diagrams" << endl;
+    BDD bdd( 6 );
+    using Sets = std::vector<std::vector<uint32_t>>;
+    auto const a = bdd.zdd_single( 0 ), b = bdd.zdd_single( 1 ), c = bdd.zdd_single( 2 ), d = bdd.zdd_single( 3 );
+    /* f = { ab, ac, d } */
+    auto const ab = bdd.ref( bdd.zdd_product( a, b ) );
+    auto const ac = bdd.ref( bdd.zdd_product( a, c ) );
+    auto const f = bdd.ref( bdd.zdd_union( bdd.zdd_union( ab, ac ), bdd.zdd_single( 3 ) ) );
+    bdd.deref( ab );
+    bdd.deref( ac );
+
+    cout << "  checking union and product";
+    passed &= check( bdd.zdd_sets( f ) == Sets( {{3}, {0, 2}, {0, 1}} ) && bdd.zdd_count( f ) == 3.0l );
+    cout << "  checking intersection and difference";
+    auto const g = bdd.ref( bdd.zdd_union( bdd.zdd_product( a, c ), bdd.zdd_base() ) );
+    passed &= check( bdd.zdd_sets( bdd.zdd_intersection( f, g ) ) == Sets( {{0, 2}} ) &&
+                     bdd.zdd_sets( bdd.zdd_difference( f, g ) ) == Sets( {{3}, {0, 1}} ) &&
+                     bdd.zdd_sets( bdd.zdd_difference( g, f ) ) == Sets( {{}} ) );
+    cout << "  checking change and subsets";
+    passed &= check( bdd.zdd_sets( bdd.zdd_change( f, 1 ) ) == Sets( {{1, 3}, {0}, {0, 1, 2}} ) &&
+                     bdd.zdd_sets( bdd.zdd_subset1( f, 0 ) ) == Sets( {{2}, {1}} ) && bdd.zdd_sets( bdd.zdd_subset0( f, 0 ) ) == Sets( {{3}} ) );
+    cout << "  checking division";
+    passed &= check( bdd.zdd_sets( bdd.zdd_divide( f, bdd.zdd_union( b, c ) ) ) == Sets( {{0}} ) &&
+                     bdd.zdd_divide( f, bdd.zdd_union( b, d ) ) == bdd.zdd_empty() && bdd.zdd_divide( f, f ) == bdd.zdd_base() );
+
+    /* The singletons of all variables: one node per variable, unlike the BDD of their characteristic function. */
+    cout << "  checking zero suppression";
+    auto singletons = bdd.ref( bdd.zdd_empty() );
+    for ( auto v = 0u; v < 6u; ++v )
+    {
+      auto const next = bdd.ref( bdd.zdd_union( singletons, bdd.zdd_single( v ) ) );
+      bdd.deref( singletons );
+      singletons = next;
+    }
+    passed &= check( bdd.num_nodes( singletons ) == 6u && bdd.zdd_count( singletons ) == 6.0l );
+
+    cout << "  checking conversion from and to BDDs";
+    auto const x = [&]( uint8_t var ) { return create_tt_nth_var( 6, var ); };
+    auto const tt = ( x( 0 ) & ~x( 3 ) ) | ( x( 1 ) ^ x( 4 ) ^ x( 5 ) ) | ( x( 2 ) & x( 3 ) );
+    auto const h = bdd.ref( bdd.from_tt( tt ) );
+    auto const z = bdd.ref( bdd.zdd_from_bdd( h ) );
+    auto const s = bdd.ref( bdd.zdd_to_bdd( singletons ) );
+    passed &= check( bdd.zdd_count( z ) == bdd.sat_count( h ) && bdd.zdd_to_bdd( z ) == h &&
+                     bdd.get_tt( s ) == Truth_Table( 6, ( 1ull << 1 ) | ( 1ull << 2 ) | ( 1ull << 4 ) | ( 1ull << 8 ) | ( 1ull << 16 ) | ( 1ull << 32 ) ) );
+
+    /* Reordering the BDDs leaves the ZDDs unchanged. */
+    cout << "  checking conversion after reordering";
+    bdd.swap_levels( 0 );
+    bdd.swap_levels( 3 );
+    passed &= check( bdd.zdd_sets( f ) == Sets( {{3}, {0, 2}, {0, 1}} ) && bdd.zdd_to_bdd( bdd.zdd_from_bdd( h ) ) == h &&
+                     bdd.zdd_from_bdd( h ) == z );
+  }
+
+  {
+    cout << "test 28: algebraic decision diagrams" << endl;
+    BDD bdd( 3 );
+    /* cost = 3 x_0 + 2.5 x_1 - x_0 x_2 */
+    auto const x0 = bdd.ref( bdd.add_from_bdd( bdd.literal( 0 ) ) );
+    auto const x1 = bdd.ref( bdd.add_from_bdd( bdd.literal( 1 ) ) );
+    auto const x02 = bdd.ref( bdd.add_from_bdd( bdd.AND( bdd.literal( 0 ), bdd.literal( 2 ) ) ) );
+    auto const a = bdd.ref( bdd.add_times( x0, bdd.add_constant( 3.0 ) ) );
+    auto const b = bdd.ref( bdd.add_times( x1, bdd.add_constant( 2.5 ) ) );
+    auto const ab = bdd.ref( bdd.add_plus( a, b ) );
+    auto const cost = bdd.ref( bdd.add_plus( ab, bdd.add_times( x02, bdd.add_constant( -1.0 ) ) ) );
+    for ( auto const f : {x0, x1, x02, a, b, ab} )
+    {
+      bdd.deref( f );
+    }
+    auto const value = []( uint32_t m ) { return 3.0 * ( m & 1u ) + 2.5 * ( m >> 1 & 1u ) - ( m & 1u ) * ( m >> 2 & 1u ); };
+    auto const assignment = []( uint32_t m ) { return std::vector<bool>( {( m & 1u ) != 0u, ( m & 2u ) != 0u, ( m & 4u ) != 0u} ); };
+
+    cout << "  checking plus and times";
+    bool correct = true;
+    for ( auto m = 0u; m < 8u; ++m )
+    {
+      correct &= bdd.add_evaluate( cost, assignment( m ) ) == value( m );
+    }
+    passed &= check( correct );
+
+    cout << "  checking min, max and threshold";
+    auto const two = bdd.add_constant( 2.0 );
+    auto const low = bdd.ref( bdd.add_min( cost, two ) );
+    auto const high = bdd.ref( bdd.add_max( cost, two ) );
+    auto const over = bdd.ref( bdd.add_threshold( cost, two ) );
+    correct = true;
+    for ( auto m = 0u; m < 8u; ++m )
+    {
+      correct &= bdd.add_evaluate( low, assignment( m ) ) == std::min( value( m ), 2.0 ) &&
+                 bdd.add_evaluate( high, assignment( m ) ) == std::max( value( m ), 2.0 ) &&
+                 bdd.add_evaluate( over, assignment( m ) ) == ( value( m ) >= 2.0 ? 1.0 : 0.0 );
+    }
+    passed &= check( correct );
+
+    cout << "  checking abstraction";
+    auto const cube = bdd.ref( bdd.AND( bdd.literal( 0 ), bdd.literal( 2 ) ) );
+    auto const total = bdd.ref( bdd.add_sum_abstract( cost, cube ) );
+    auto const worst = bdd.ref( bdd.add_max_abstract( cost, cube ) );
+    correct = bdd.add_evaluate( bdd.add_sum_abstract( cost, bdd.literal( 1 ) ), assignment( 0 ) ) == value( 0 ) + value( 2 );
+    for ( auto m = 0u; m < 8u; ++m )
+    {
+      double sum = 0.0, max = value( m & 2u );
+      for ( auto const n : {0u, 1u, 4u, 5u} )
+      {
+        sum += value( ( m & 2u ) | n );
+        max = std::max( max, value( ( m & 2u ) | n ) );
+      }
+      correct &= bdd.add_evaluate( total, assignment( m ) ) == sum && bdd.add_evaluate( worst, assignment( m ) ) == max;
+    }
+    passed &= check( correct );
+
+    cout << "  checking conversion to BDDs";
+    auto const expensive = bdd.ref( bdd.add_to_bdd( cost, 2.5 ) );
+    correct = bdd.add_from_bdd( bdd.add_to_bdd( over, 1.0 ) ) == over;
+    for ( auto m = 0u; m < 8u; ++m )
+    {
+      correct &= bdd.get_tt( expensive ).get_bit( m ) == ( value( m ) >= 2.5 );
+    }
+    passed &= check( correct );
+
+    /* The terminals are collected with the other nodes. */
+    cout << "  checking garbage collection of the terminals";
+    for ( auto const f : {cost, low, high, over, cube, total, worst, expensive} )
+    {
+      bdd.deref( f );
+    }
+    bdd.garbage_collect();
+    passed &= check( bdd.num_nodes() == 0u && bdd.add_value( bdd.add_constant( 3.0 ) ) == 3.0 );
+
+    /* Summing over more than 1023 variables: 2^1100 is not a double. */
+    cout << "  checking abstraction over many variables";
+    uint32_t const n = 1100u;
+    BDD wide( n );
+    auto minterm = wide.constant( true ); /* the ADD of x_0 ~x_1 x_2 ~x_3 ... */
+    auto all = wide.constant( true ); /* the BDD cube of all variables */
+    auto first = wide.constant( true ); /* the BDD cube of x_0, ..., x_9 */
+    for ( auto v = n; v-- > 0u; )
+    {
+      minterm = v % 2 == 0 ? wide.add_unique( v, minterm, wide.constant( false ) ) : wide.add_unique( v, wide.constant( false ), minterm );
+      all = wide.unique( v, all, wide.constant( false ) );
+      first = v < 10u ? wide.unique( v, first, wide.constant( false ) ) : first;
+    }
+    wide.ref( minterm );
+    wide.ref( all );
+    wide.ref( first );
+    passed &= check( wide.add_sum_abstract( minterm, all ) == wide.constant( true ) && wide.add_max_abstract( minterm, all ) == wide.constant( true ) &&
+                     wide.add_value( wide.add_sum_abstract( wide.constant( true ), first ) ) == 1024.0 );
+  }
+
+  {
+    cout << "test 29: irredundant sums of products" << endl;
+    auto const x = [&]( uint8_t var ) { return create_tt_nth_var( 8, var ); };
+    auto const tt_on = ( x( 0 ) & x( 1 ) & ~x( 7 ) ) | ( x( 2 ) ^ x( 6 ) ) | ( x( 3 ) & x( 4 ) & x( 5 ) );
+    auto const tt_dc = x( 1 ) & x( 2 ) & x( 7 );
+    auto const tt_upper = tt_on | tt_dc;
+
+    /* Every cube is needed: removing it uncovers a point of the on-set. */
+    auto const irredundant = [&]( std::vector<Packed_Cube> const& cubes, Truth_Table const& lower ) {
+      for ( auto i = 0u; i < cubes.size(); ++i )
+      {
+        std::vector<Packed_Cube> others( cubes );
+        others.erase( others.begin() + i );
+        if ( ( cubes_to_tt( others, lower.num_var ) & lower ) == lower )
+        {
+          return false;
+        }
+      }
+      return true;
+    };
+
+    cout << "  checking truth table ISOP";
+    auto const cubes = isop( tt_on, tt_on );
+    passed &= check( cubes_to_tt( cubes, 8 ) == tt_on && irredundant( cubes, tt_on ) );
+    cout << "  checking truth table ISOP with don't cares";
+    auto const dc_cubes = isop( tt_on, tt_upper );
+    auto const tt_cover = cubes_to_tt( dc_cubes, 8 );
+    passed &= check( ( tt_cover & tt_on ) == tt_on && ( tt_cover & ~tt_upper ) == Truth_Table( 8 ) && irredundant( dc_cubes, tt_on ) &&
+                     dc_cubes.size() <= cubes.size() );
+    cout << "  checking small truth tables";
+    auto const tt_small = Truth_Table( 3, 0xe8 ); /* majority */
+    passed &= check( isop( tt_small, tt_small ).size() == 3u && cubes_to_tt( isop( tt_small, tt_small ), 3 ) == tt_small &&
+                     isop( Truth_Table( 3 ), ~Truth_Table( 3 ) ).empty() && isop( ~Truth_Table( 3 ), ~Truth_Table( 3 ) ).size() == 1u );
+
+    BDD bdd( 8 );
+    auto const on = bdd.ref( bdd.from_tt( tt_on ) );
+    auto const upper = bdd.ref( bdd.from_tt( tt_upper ) );
+    cout << "  checking BDD ISOP";
+    auto const cover = bdd.ref( bdd.isop( on, upper ) );
+    auto const bdd_cubes = bdd.isop_cubes( on, upper );
+    std::vector<Packed_Cube> packed;
+    for ( auto const& cube : bdd_cubes )
+    {
+      Packed_Cube p( {0u, 0u} );
+      for ( auto v = 0u; v < 8u; ++v )
+      {
+        if ( cube[v] != -1 )
+        {
+          p.mask |= 1u << v;
+          p.polarity |= uint64_t( cube[v] ) << v;
+        }
+      }
+      packed.emplace_back( p );
+    }
+    auto const tt_bdd_cover = bdd.get_tt( cover );
+    passed &= check( ( tt_bdd_cover & tt_on ) == tt_on && ( tt_bdd_cover & ~tt_upper ) == Truth_Table( 8 ) &&
+                     cubes_to_tt( packed, 8 ) == tt_bdd_cover && irredundant( packed, tt_on ) );
+    cout << "  checking cube counts and caching";
+    uint64_t const invocations = bdd.num_invoke();
+    passed &= check( bdd.isop( on, upper ) == cover && bdd.num_invoke() == invocations + 1u && bdd.isop_num_cubes( on, upper ) == bdd_cubes.size() &&
+                     bdd.isop_num_cubes( on, on ) == bdd.isop_cubes( on, on ).size() );
+    cout << "  checking cube counts without enumeration";
+    BDD wide( 40 );
+    auto parity = wide.constant( false );
+    for ( auto i = 0u; i < 40u; ++i )
+    {
+      parity = wide.XOR( parity, wide.literal( i ) );
+    }
+    passed &= checkEQ( wide.isop_num_cubes( parity, parity ), uint64_t( 1 ) << 39 );
+  }
+
   if ( passed )
   {
     cout << endl << "All tests passed, congrats!" << endl;
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#if defined( __unix__ ) || defined( __APPLE__ )
+#define BDD_HAS_MMAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* A read-only view of the contents of a file, mapped into memory with `mmap` where available
+ * (so that the pages are only read when accessed and shared with the page cache), or read
+ * into a buffer otherwise. Throws `std::runtime_error` if the file cannot be opened. */
+class Mapped_File
+{
+public:
+  explicit Mapped_File( std::string const& filename ) : address( nullptr ), length( 0u )
+  {
+#ifdef BDD_HAS_MMAP
+    int const fd = open( filename.c_str(), O_RDONLY );
+    if ( fd < 0 )
+    {
+      throw std::runtime_error( "cannot open " + filename );
+    }
+    struct stat status;
+    if ( fstat( fd, &status ) != 0 )
+    {
+      close( fd );
+      throw std::runtime_error( "cannot read " + filename );
+    }
+    length = status.st_size;
+    if ( length != 0u )
+    {
+      void* const mapping = mmap( nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0 );
+      if ( mapping == MAP_FAILED )
+      {
+        close( fd );
+        throw std::runtime_error( "cannot map " + filename );
+      }
+      address = static_cast<uint8_t const*>( mapping );
+    }
+    close( fd );
+#else
+    std::ifstream is( filename, std::ios::binary );
+    if ( !is )
+    {
+      throw std::runtime_error( "cannot open " + filename );
+    }
+    buffer.assign( std::istreambuf_iterator<char>( is ), std::istreambuf_iterator<char>() );
+    address = reinterpret_cast<uint8_t const*>( buffer.data() );
+    length = buffer.size();
+#endif
+  }
+
+  Mapped_File( Mapped_File const& ) = delete;
+  Mapped_File& operator=( Mapped_File const& ) = delete;
+
+  ~Mapped_File()
+  {
+#ifdef BDD_HAS_MMAP
+    if ( address != nullptr )
+    {
+      munmap( const_cast<uint8_t*>( address ), length );
+    }
+#endif
+  }
+
+  uint8_t const* data() const
+  {
+    return address;
+  }
+
+  uint64_t size() const
+  {
+    return length;
+  }
+
+private:
+  uint8_t const* address;
+  uint64_t length;
+#ifndef BDD_HAS_MMAP
+  std::vector<char> buffer;
+#endif
+};
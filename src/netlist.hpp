@@ -0,0 +1,645 @@
+#pragma once
+
+#include "BDD.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/* A combinational netlist read from an AIGER, BLIF or PLA file.
+ *
+ * Signals are numbered: 0 is the constant 0, 1 to `inputs.size()` are the primary inputs, and
+ * the following ones are the outputs of `gates`, in order. A literal is a signal with a
+ * complement bit, `2 * signal + complemented`, so that literal 1 is the constant 1.
+ * The latches of sequential circuits are cut: their outputs become inputs, and their next-state
+ * functions become outputs. */
+struct Netlist
+{
+  /* A gate computes a sum of products over its fanins, complemented if `polarity` is false.
+   * Each cube holds one character per fanin: '1' (the fanin), '0' (its complement) or '-'. */
+  struct Gate
+  {
+    std::vector<uint32_t> fanins; /* literals */
+    std::vector<std::string> cubes;
+    bool polarity;
+  };
+
+  std::vector<std::string> inputs; /* names */
+  std::vector<std::string> outputs; /* names */
+  std::vector<uint32_t> output_literals;
+  std::vector<Gate> gates;
+
+  uint32_t num_signals() const
+  {
+    return 1u + inputs.size() + gates.size();
+  }
+
+  uint32_t add_gate( std::vector<uint32_t> const& fanins, std::vector<std::string> const& cubes, bool polarity )
+  {
+    gates.emplace_back( Gate( {fanins, cubes, polarity} ) );
+    return ( num_signals() - 1u ) << 1;
+  }
+};
+
+namespace netlist_detail
+{
+
+inline std::runtime_error parse_error( std::string const& format, std::string const& message )
+{
+  return std::runtime_error( format + ": " + message );
+}
+
+inline uint32_t to_number( std::string const& format, std::string const& token )
+{
+  if ( token.empty() || token.find_first_not_of( "0123456789" ) != std::string::npos )
+  {
+    throw parse_error( format, "expected a number instead of \"" + token + "\"" );
+  }
+  return std::stoul( token );
+}
+
+/* The whitespace-separated tokens of `line`. */
+inline std::vector<std::string> tokenize( std::string const& line )
+{
+  std::istringstream is( line );
+  std::vector<std::string> tokens;
+  std::string token;
+  while ( is >> token )
+  {
+    tokens.emplace_back( token );
+  }
+  return tokens;
+}
+
+/* Read the next line that is neither empty nor a comment (from '#' on), joining the lines
+ * continued with a trailing '\'. Returns false at the end of the stream. */
+inline bool next_line( std::istream& is, std::vector<std::string>& tokens )
+{
+  std::string line, part;
+  while ( std::getline( is, part ) )
+  {
+    std::size_t const comment = part.find( '#' );
+    if ( comment != std::string::npos )
+    {
+      part.erase( comment );
+    }
+    if ( !part.empty() && part.back() == '\r' )
+    {
+      part.pop_back();
+    }
+    if ( !part.empty() && part.back() == '\\' )
+    {
+      part.pop_back();
+      line += part + ' ';
+      continue;
+    }
+    line += part;
+    tokens = tokenize( line );
+    if ( !tokens.empty() )
+    {
+      return true;
+    }
+    line.clear();
+  }
+  tokens.clear();
+  return false;
+}
+
+/* Read an unsigned integer of the binary AIGER format: 7 bits per byte, the lowest first. */
+inline uint32_t read_aiger_delta( std::istream& is )
+{
+  uint32_t value = 0u;
+  for ( uint32_t shift = 0u; shift < 35u; shift += 7u )
+  {
+    int const byte = is.get();
+    if ( byte == std::char_traits<char>::eof() )
+    {
+      throw parse_error( "AIGER", "unexpected end of the AND gates" );
+    }
+    value |= uint32_t( byte & 0x7f ) << shift;
+    if ( ( byte & 0x80 ) == 0 )
+    {
+      return value;
+    }
+  }
+  throw parse_error( "AIGER", "invalid AND gate encoding" );
+}
+
+} // namespace netlist_detail
+
+/* Read a netlist in the AIGER format, ASCII ("aag") or binary ("aig"), including the bad state
+ * and invariant constraint properties of AIGER 1.9 as outputs. Throws `std::runtime_error` if
+ * the input is malformed. */
+inline Netlist read_aiger( std::istream& is )
+{
+  using namespace netlist_detail;
+  std::string line;
+  std::getline( is, line );
+  auto const header = tokenize( line );
+  if ( header.size() < 6u || ( header[0] != "aag" && header[0] != "aig" ) )
+  {
+    throw parse_error( "AIGER", "invalid header" );
+  }
+  bool const binary = header[0] == "aig";
+  std::vector<uint32_t> counts; /* M I L O A B C J F */
+  for ( auto i = 1u; i < header.size(); ++i )
+  {
+    counts.emplace_back( to_number( "AIGER", header[i] ) );
+  }
+  counts.resize( 9u, 0u );
+  uint32_t const M = counts[0], I = counts[1], L = counts[2], O = counts[3], A = counts[4];
+  uint32_t const B = counts[5], C = counts[6];
+  if ( counts[7] != 0u || counts[8] != 0u )
+  {
+    throw parse_error( "AIGER", "justice and fairness properties are not supported" );
+  }
+  if ( binary && M != I + L + A )
+  {
+    throw parse_error( "AIGER", "invalid header" );
+  }
+
+  auto const read_numbers = [&]( uint32_t min_count ) {
+    if ( !std::getline( is, line ) )
+    {
+      throw parse_error( "AIGER", "unexpected end of file" );
+    }
+    std::vector<uint32_t> numbers;
+    for ( auto const& token : tokenize( line ) )
+    {
+      numbers.emplace_back( to_number( "AIGER", token ) );
+    }
+    if ( numbers.size() < min_count )
+    {
+      throw parse_error( "AIGER", "missing number in \"" + line + "\"" );
+    }
+    return numbers;
+  };
+
+  /* The netlist literal of each AIGER variable (or 1 if undefined). */
+  Netlist netlist;
+  std::vector<uint32_t> literal_of( M + 1u, 1u );
+  literal_of[0] = 0u;
+  auto const define = [&]( uint32_t aiger_literal, uint32_t literal ) {
+    if ( ( aiger_literal & 1u ) != 0u || aiger_literal < 2u || ( aiger_literal >> 1 ) > M || literal_of[aiger_literal >> 1] != 1u )
+    {
+      throw parse_error( "AIGER", "invalid definition of literal " + std::to_string( aiger_literal ) );
+    }
+    literal_of[aiger_literal >> 1] = literal;
+  };
+
+  for ( auto i = 0u; i < I; ++i )
+  {
+    netlist.inputs.emplace_back( "i" + std::to_string( i ) );
+    define( binary ? 2u * ( i + 1u ) : read_numbers( 1u )[0], netlist.inputs.size() << 1 );
+  }
+  std::vector<uint32_t> next_states;
+  for ( auto l = 0u; l < L; ++l )
+  {
+    auto const numbers = read_numbers( binary ? 1u : 2u );
+    netlist.inputs.emplace_back( "l" + std::to_string( l ) );
+    define( binary ? 2u * ( I + l + 1u ) : numbers[0], netlist.inputs.size() << 1 );
+    next_states.emplace_back( numbers[binary ? 0u : 1u] );
+  }
+  std::vector<uint32_t> outputs;
+  for ( auto o = 0u; o < O + B + C; ++o )
+  {
+    outputs.emplace_back( read_numbers( 1u )[0] );
+    netlist.outputs.emplace_back( o < O ? "o" + std::to_string( o ) : o < O + B ? "b" + std::to_string( o - O ) : "c" + std::to_string( o - O - B ) );
+  }
+  for ( auto l = 0u; l < L; ++l )
+  {
+    outputs.emplace_back( next_states[l] );
+    netlist.outputs.emplace_back( "l" + std::to_string( l ) + "_next" );
+  }
+
+  /* The gates refer to AIGER literals until all are defined, since the ASCII format allows any order. */
+  for ( auto a = 0u; a < A; ++a )
+  {
+    uint32_t lhs, rhs0, rhs1;
+    if ( binary )
+    {
+      lhs = 2u * ( I + L + a + 1u );
+      uint32_t const delta0 = read_aiger_delta( is );
+      uint32_t const delta1 = read_aiger_delta( is );
+      if ( delta0 > lhs || delta1 > lhs - delta0 )
+      {
+        throw parse_error( "AIGER", "invalid AND gate encoding" );
+      }
+      rhs0 = lhs - delta0;
+      rhs1 = rhs0 - delta1;
+    }
+    else
+    {
+      auto const numbers = read_numbers( 3u );
+      lhs = numbers[0];
+      rhs0 = numbers[1];
+      rhs1 = numbers[2];
+    }
+    define( lhs, netlist.add_gate( {rhs0, rhs1}, {"11"}, true ) );
+  }
+  auto const resolve = [&]( uint32_t aiger_literal ) {
+    if ( ( aiger_literal >> 1 ) > M || literal_of[aiger_literal >> 1] == 1u )
+    {
+      throw parse_error( "AIGER", "undefined literal " + std::to_string( aiger_literal ) );
+    }
+    return literal_of[aiger_literal >> 1] ^ ( aiger_literal & 1u );
+  };
+  for ( auto& gate : netlist.gates )
+  {
+    for ( auto& fanin : gate.fanins )
+    {
+      fanin = resolve( fanin );
+    }
+  }
+  for ( auto const output : outputs )
+  {
+    netlist.output_literals.emplace_back( resolve( output ) );
+  }
+
+  /* symbol table, up to the comments */
+  while ( std::getline( is, line ) && !line.empty() && line[0] != 'c' )
+  {
+    std::size_t const space = line.find( ' ' );
+    if ( space == std::string::npos || space < 2u || ( line[0] != 'i' && line[0] != 'l' && line[0] != 'o' ) )
+    {
+      continue;
+    }
+    uint32_t const position = to_number( "AIGER", line.substr( 1u, space - 1u ) );
+    std::string const name = line.substr( space + 1u );
+    if ( line[0] == 'i' && position < I )
+    {
+      netlist.inputs[position] = name;
+    }
+    else if ( line[0] == 'l' && position < L )
+    {
+      netlist.inputs[I + position] = name;
+      netlist.outputs[O + B + C + position] = name + "_next";
+    }
+    else if ( line[0] == 'o' && position < O )
+    {
+      netlist.outputs[position] = name;
+    }
+  }
+  return netlist;
+}
+
+/* Read a netlist in the BLIF format: the first model, made of `.names` covers and `.latch`es
+ * (cut as described above). Throws `std::runtime_error` if the input is malformed. */
+inline Netlist read_blif( std::istream& is )
+{
+  using namespace netlist_detail;
+  Netlist netlist;
+  std::unordered_map<std::string, uint32_t> signal_of( {{"$false", 0u}} );
+  std::vector<std::string> output_names, latch_inputs;
+  std::vector<std::vector<std::string>> fanin_names; /* per gate, resolved at the end */
+
+  std::vector<std::string> tokens;
+  bool pending = next_line( is, tokens );
+  while ( pending )
+  {
+    std::string const keyword = tokens[0];
+    if ( keyword == ".inputs" )
+    {
+      for ( auto i = 1u; i < tokens.size(); ++i )
+      {
+        netlist.inputs.emplace_back( tokens[i] );
+        signal_of[tokens[i]] = netlist.inputs.size();
+      }
+    }
+    else if ( keyword == ".outputs" )
+    {
+      output_names.insert( output_names.end(), tokens.begin() + 1, tokens.end() );
+    }
+    else if ( keyword == ".latch" )
+    {
+      if ( tokens.size() < 3u )
+      {
+        throw parse_error( "BLIF", "invalid .latch" );
+      }
+      netlist.inputs.emplace_back( tokens[2] );
+      signal_of[tokens[2]] = netlist.inputs.size();
+      latch_inputs.emplace_back( tokens[1] );
+    }
+    else if ( keyword == ".names" )
+    {
+      if ( tokens.size() < 2u )
+      {
+        throw parse_error( "BLIF", "invalid .names" );
+      }
+      std::vector<std::string> const names( tokens.begin() + 1, tokens.end() - 1 );
+      std::string const output = tokens.back();
+      std::vector<std::string> cubes;
+      bool polarity = true;
+      while ( ( pending = next_line( is, tokens ) ) && tokens[0][0] != '.' )
+      {
+        if ( tokens.size() != ( names.empty() ? 1u : 2u ) || ( !names.empty() && tokens[0].size() != names.size() ) )
+        {
+          throw parse_error( "BLIF", "invalid cube of " + output );
+        }
+        polarity = tokens.back() == "1";
+        cubes.emplace_back( names.empty() ? "" : tokens[0] );
+      }
+      if ( signal_of.count( output ) != 0u )
+      {
+        throw parse_error( "BLIF", output + " is defined twice" );
+      }
+      /* A cover without cubes is the constant 0. */
+      fanin_names.emplace_back( names );
+      signal_of[output] = netlist.add_gate( std::vector<uint32_t>( names.size() ), cubes, polarity ) >> 1;
+      continue;
+    }
+    else if ( keyword == ".end" )
+    {
+      break;
+    }
+    else if ( keyword[0] != '.' )
+    {
+      throw parse_error( "BLIF", "unexpected \"" + keyword + "\"" );
+    }
+    /* other constructs (.model, .default_input_arrival, ...) are ignored */
+    pending = next_line( is, tokens );
+  }
+
+  auto const resolve = [&]( std::string const& name ) {
+    auto const it = signal_of.find( name );
+    if ( it == signal_of.end() )
+    {
+      throw parse_error( "BLIF", "undefined signal " + name );
+    }
+    return it->second << 1;
+  };
+  for ( auto g = 0u; g < netlist.gates.size(); ++g )
+  {
+    for ( auto i = 0u; i < fanin_names[g].size(); ++i )
+    {
+      netlist.gates[g].fanins[i] = resolve( fanin_names[g][i] );
+    }
+  }
+  for ( auto const& name : output_names )
+  {
+    netlist.outputs.emplace_back( name );
+    netlist.output_literals.emplace_back( resolve( name ) );
+  }
+  for ( auto const& name : latch_inputs )
+  {
+    netlist.outputs.emplace_back( name );
+    netlist.output_literals.emplace_back( resolve( name ) );
+  }
+  return netlist;
+}
+
+/* Read a netlist in the (Espresso) PLA format: one cover per output, over the inputs. An output
+ * of a cube is in the cover if its character is '1' (or '4'); the others ('0', '-', '~', ...)
+ * are ignored, so the on-set is read whatever the `.type`. Throws `std::runtime_error` if the
+ * input is malformed. */
+inline Netlist read_pla( std::istream& is )
+{
+  using namespace netlist_detail;
+  Netlist netlist;
+  uint32_t num_inputs = 0u, num_outputs = 0u;
+  std::vector<std::string> input_names, output_names;
+  std::vector<std::vector<std::string>> covers;
+
+  std::vector<std::string> tokens;
+  while ( next_line( is, tokens ) )
+  {
+    std::string const keyword = tokens[0];
+    if ( keyword == ".i" && tokens.size() == 2u )
+    {
+      num_inputs = to_number( "PLA", tokens[1] );
+    }
+    else if ( keyword == ".o" && tokens.size() == 2u )
+    {
+      num_outputs = to_number( "PLA", tokens[1] );
+      covers.resize( num_outputs );
+    }
+    else if ( keyword == ".ilb" )
+    {
+      input_names.assign( tokens.begin() + 1, tokens.end() );
+    }
+    else if ( keyword == ".ob" )
+    {
+      output_names.assign( tokens.begin() + 1, tokens.end() );
+    }
+    else if ( keyword == ".e" || keyword == ".end" )
+    {
+      break;
+    }
+    else if ( keyword[0] != '.' )
+    {
+      /* a cube: the input part and the output part, possibly not separated */
+      std::string cube;
+      for ( auto const& token : tokens )
+      {
+        cube += token;
+      }
+      if ( num_outputs == 0u || cube.size() != num_inputs + num_outputs )
+      {
+        throw parse_error( "PLA", "invalid cube \"" + cube + "\"" );
+      }
+      for ( auto o = 0u; o < num_outputs; ++o )
+      {
+        if ( cube[num_inputs + o] == '1' || cube[num_inputs + o] == '4' )
+        {
+          covers[o].emplace_back( cube.substr( 0u, num_inputs ) );
+        }
+      }
+    }
+    /* other keywords (.p, .type, .phase, ...) are ignored */
+  }
+
+  std::vector<uint32_t> inputs;
+  for ( auto i = 0u; i < num_inputs; ++i )
+  {
+    netlist.inputs.emplace_back( i < input_names.size() ? input_names[i] : "i" + std::to_string( i ) );
+    inputs.emplace_back( ( i + 1u ) << 1 );
+  }
+  for ( auto o = 0u; o < num_outputs; ++o )
+  {
+    netlist.outputs.emplace_back( o < output_names.size() ? output_names[o] : "o" + std::to_string( o ) );
+    netlist.output_literals.emplace_back( netlist.add_gate( inputs, covers[o], true ) );
+  }
+  return netlist;
+}
+
+/* Read a netlist, choosing the format from the extension of `filename` (.aag, .aig, .blif or .pla). */
+inline Netlist read_netlist( std::string const& filename )
+{
+  std::ifstream is( filename, std::ios::binary );
+  if ( !is )
+  {
+    throw std::runtime_error( "cannot open " + filename );
+  }
+  std::string const extension = filename.substr( filename.find_last_of( '.' ) + 1u );
+  if ( extension == "aag" || extension == "aig" )
+  {
+    return read_aiger( is );
+  }
+  if ( extension == "blif" )
+  {
+    return read_blif( is );
+  }
+  if ( extension == "pla" )
+  {
+    return read_pla( is );
+  }
+  throw std::runtime_error( "unknown netlist format: " + filename );
+}
+
+/* Statistics of `build_bdds`. The time of an output is the time spent on the gates built for it,
+ * i.e., excluding the ones shared with the previous outputs. */
+struct Netlist_Stats
+{
+  struct Output
+  {
+    std::string name;
+    uint64_t nodes;
+    double seconds;
+  };
+
+  std::vector<Output> outputs;
+  uint64_t peak_live_nodes;
+  double seconds;
+};
+
+/* Build the BDDs of the outputs of `netlist`, returned referenced. Input `i` is variable `i`.
+ * The outputs are built one after the other, each gate after its fanins. The BDD of a gate is
+ * dereferenced as soon as its last fanout is built, to keep the peak number of nodes low.
+ * Throws `std::runtime_error` if the netlist has a combinational cycle. */
+template<typename Index>
+std::vector<Index> build_bdds( Basic_BDD<Index>& bdd, Netlist const& netlist, Netlist_Stats* stats = nullptr )
+{
+  assert( netlist.inputs.size() <= bdd.num_vars() && "Make sure the manager has a variable per input." );
+  uint32_t const first_gate = 1u + netlist.inputs.size();
+
+  /* remaining uses of the BDD of each gate, by the outputs and the gates in their cones */
+  std::vector<uint32_t> fanouts( netlist.num_signals(), 0u );
+  std::vector<uint32_t> stack;
+  for ( auto const literal : netlist.output_literals )
+  {
+    if ( fanouts[literal >> 1]++ == 0u )
+    {
+      stack.emplace_back( literal >> 1 );
+    }
+  }
+  while ( !stack.empty() )
+  {
+    uint32_t const signal = stack.back();
+    stack.pop_back();
+    if ( signal < first_gate )
+    {
+      continue;
+    }
+    for ( auto const fanin : netlist.gates[signal - first_gate].fanins )
+    {
+      if ( fanouts[fanin >> 1]++ == 0u )
+      {
+        stack.emplace_back( fanin >> 1 );
+      }
+    }
+  }
+
+  enum State : uint8_t
+  {
+    NEW,
+    VISITING,
+    BUILT
+  };
+  std::vector<State> state( netlist.num_signals(), NEW );
+  std::vector<Index> functions( netlist.num_signals(), bdd.constant( false ) );
+  auto const function = [&]( uint32_t literal ) {
+    uint32_t const signal = literal >> 1;
+    Index const f = signal == 0u ? bdd.constant( false ) : signal < first_gate ? bdd.literal( signal - 1u ) : functions[signal];
+    return f ^ ( literal & 1u );
+  };
+  auto const release = [&]( uint32_t literal ) {
+    uint32_t const signal = literal >> 1;
+    if ( signal >= first_gate && --fanouts[signal] == 0u )
+    {
+      bdd.deref( functions[signal] );
+    }
+  };
+  auto const build_gate = [&]( Netlist::Gate const& gate ) {
+    Index sum = bdd.ref( bdd.constant( false ) );
+    for ( auto const& cube : gate.cubes )
+    {
+      Index product = bdd.constant( true );
+      for ( auto i = 0u; i < gate.fanins.size(); ++i )
+      {
+        if ( cube[i] != '-' )
+        {
+          product = bdd.AND( product, function( gate.fanins[i] ^ ( cube[i] == '0' ) ) );
+        }
+      }
+      Index const next = bdd.ref( bdd.OR( sum, product ) );
+      bdd.deref( sum );
+      sum = next;
+    }
+    return sum ^ !gate.polarity;
+  };
+
+  if ( stats != nullptr )
+  {
+    stats->outputs.clear();
+    stats->peak_live_nodes = bdd.num_live_nodes();
+    stats->seconds = 0.0;
+  }
+  std::vector<Index> outputs;
+  for ( auto o = 0u; o < netlist.output_literals.size(); ++o )
+  {
+    auto const start = std::chrono::steady_clock::now();
+
+    /* Build the cone of the output in post-order. */
+    stack.emplace_back( netlist.output_literals[o] >> 1 );
+    while ( !stack.empty() )
+    {
+      uint32_t const signal = stack.back();
+      if ( signal < first_gate || state[signal] == BUILT )
+      {
+        stack.pop_back();
+        continue;
+      }
+      Netlist::Gate const& gate = netlist.gates[signal - first_gate];
+      if ( state[signal] == NEW )
+      {
+        state[signal] = VISITING;
+        for ( auto const fanin : gate.fanins )
+        {
+          if ( state[fanin >> 1] == VISITING )
+          {
+            throw std::runtime_error( "the netlist has a combinational cycle" );
+          }
+          stack.emplace_back( fanin >> 1 );
+        }
+        continue;
+      }
+      stack.pop_back();
+      functions[signal] = build_gate( gate );
+      state[signal] = BUILT;
+      for ( auto const fanin : gate.fanins )
+      {
+        release( fanin );
+      }
+      if ( stats != nullptr )
+      {
+        stats->peak_live_nodes = std::max( stats->peak_live_nodes, bdd.num_live_nodes() );
+      }
+    }
+
+    outputs.emplace_back( bdd.ref( function( netlist.output_literals[o] ) ) );
+    release( netlist.output_literals[o] );
+    if ( stats != nullptr )
+    {
+      double const seconds = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+      stats->outputs.emplace_back( Netlist_Stats::Output( {netlist.outputs[o], bdd.num_nodes( outputs.back() ), seconds} ) );
+      stats->seconds += seconds;
+    }
+  }
+  return outputs;
+}
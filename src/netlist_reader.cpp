@@ -0,0 +1,42 @@
+#include "netlist.hpp"
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+using namespace std;
+
+/* Build the BDDs of the outputs of a netlist and report their sizes and build times.
+ * Usage: bdd_netlist file.{aag,aig,blif,pla} [--reorder] */
+
+int main( int argc, char** argv )
+{
+  if ( argc < 2 )
+  {
+    cerr << "usage: " << argv[0] << " file.{aag,aig,blif,pla} [--reorder]" << endl;
+    return 1;
+  }
+
+  try
+  {
+    Netlist const netlist = read_netlist( argv[1] );
+    cout << argv[1] << ": " << netlist.inputs.size() << " inputs, " << netlist.outputs.size() << " outputs, "
+         << netlist.gates.size() << " gates" << endl;
+
+    BDD bdd( netlist.inputs.size(), 1u << 20 );
+    bdd.set_reordering( argc > 2 && string( argv[2] ) == "--reorder" );
+    Netlist_Stats stats;
+    build_bdds( bdd, netlist, &stats );
+    for ( auto const& output : stats.outputs )
+    {
+      cout << "  " << output.name << ": " << output.nodes << " nodes, " << output.seconds << " s" << endl;
+    }
+    cout << "total: " << bdd.num_live_nodes() << " live nodes, peak " << stats.peak_live_nodes << ", " << stats.seconds << " s" << endl;
+  }
+  catch ( std::exception const& e )
+  {
+    cerr << e.what() << endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/* A growable array of trivially copyable elements stored in fixed-size pages.
+ *
+ * Unlike `std::vector`, growing never moves the existing elements, so references
+ * to them stay valid, and there is no transient copy of the whole array.
+ * Each page holds `1 << page_bits` elements and starts on a cache line boundary.
+ * `Index` is the type of the positions (and of the size). */
+template<typename T, typename Index, uint32_t page_bits = 16u>
+class Node_Store
+{
+public:
+  Node_Store() : count( 0u ) {}
+
+  Node_Store( Node_Store const& ) = delete;
+  Node_Store& operator=( Node_Store const& ) = delete;
+
+  Index size() const
+  {
+    return count;
+  }
+
+  T& operator[]( Index i )
+  {
+    return pages[i >> page_bits].elements[i & page_mask()];
+  }
+
+  T const& operator[]( Index i ) const
+  {
+    return pages[i >> page_bits].elements[i & page_mask()];
+  }
+
+  void emplace_back( T const& value )
+  {
+    if ( ( count >> page_bits ) == pages.size() )
+    {
+      add_page();
+    }
+    ( *this )[count++] = value;
+  }
+
+  /* Grow to `n` elements, initializing the new ones to `value`. Never shrinks. */
+  void resize( Index n, T const& value )
+  {
+    while ( count < n )
+    {
+      emplace_back( value );
+    }
+  }
+
+  /* Number of bytes allocated. */
+  uint64_t memory() const
+  {
+    return pages.size() * ( sizeof( T ) * ( uint64_t( 1u ) << page_bits ) + cache_line() );
+  }
+
+private:
+  struct Page
+  {
+    std::unique_ptr<char[]> memory;
+    T* elements; /* first cache line boundary in `memory` */
+  };
+
+  static Index page_mask()
+  {
+    return ( Index( 1u ) << page_bits ) - 1u;
+  }
+
+  static uint64_t cache_line()
+  {
+    return 64u;
+  }
+
+  void add_page()
+  {
+    Page page;
+    page.memory.reset( new char[sizeof( T ) * ( uint64_t( 1u ) << page_bits ) + cache_line()] );
+    uintptr_t const address = reinterpret_cast<uintptr_t>( page.memory.get() );
+    page.elements = reinterpret_cast<T*>( ( address + cache_line() - 1u ) & ~uintptr_t( cache_line() - 1u ) );
+    pages.emplace_back( std::move( page ) );
+  }
+
+private:
+  std::vector<Page> pages;
+  Index count;
+};
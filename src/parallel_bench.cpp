@@ -0,0 +1,58 @@
+#include "BDD.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+/* Thread scaling of the parallel operations.
+ * Usage: bdd_parallel_bench [n [max_threads]]
+ *
+ * For each number of threads from 1 to `max_threads` (default: the number of cores),
+ * builds OR_i( x_i & x_{n+i} ) over 2n variables in the bad order x_0, ..., x_{2n-1}
+ * (2^(n+1) nodes) and then the XOR and ITE of it with a shifted copy of itself,
+ * starting each time from an empty manager. */
+
+uint64_t run( uint32_t n, uint32_t num_threads, double& seconds )
+{
+  BDD bdd( 2u * n + 1u, 1u << 22 );
+  bdd.set_num_threads( num_threads );
+
+  auto const start = chrono::steady_clock::now();
+  auto f = bdd.ref( bdd.constant( false ) );
+  auto g = bdd.ref( bdd.constant( false ) );
+  for ( auto i = 0u; i < n; ++i )
+  {
+    auto const f_next = bdd.ref( bdd.OR( f, bdd.AND( bdd.literal( i ), bdd.literal( n + i ) ) ) );
+    auto const g_next = bdd.ref( bdd.OR( g, bdd.AND( bdd.literal( i + 1u ), bdd.literal( n + i + 1u ) ) ) );
+    bdd.deref( f );
+    bdd.deref( g );
+    f = f_next;
+    g = g_next;
+  }
+  auto const h = bdd.ref( bdd.XOR( f, g ) );
+  auto const r = bdd.ITE( bdd.literal( n ), h, bdd.NOT( f ) );
+  seconds = chrono::duration<double>( chrono::steady_clock::now() - start ).count();
+  return bdd.num_nodes( r );
+}
+
+int main( int argc, char** argv )
+{
+  uint32_t const n = argc > 1 ? atoi( argv[1] ) : 18u;
+  uint32_t const max_threads = argc > 2 ? atoi( argv[2] ) : max( thread::hardware_concurrency(), 1u );
+
+  double base = 0.0;
+  for ( auto t = 1u; t <= max_threads; ++t )
+  {
+    double seconds;
+    uint64_t const size = run( n, t, seconds );
+    if ( t == 1u )
+    {
+      base = seconds;
+    }
+    cout << "threads " << t << ": " << seconds << " s, speedup " << base / seconds << " (result has " << size << " nodes)" << endl;
+  }
+  return 0;
+}
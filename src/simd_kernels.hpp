@@ -0,0 +1,455 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#if defined( __GNUC__ ) && defined( __x86_64__ )
+#define BDD_SIMD_X86
+#include <immintrin.h>
+#endif
+
+/* Kernels over arrays of 64-bit words, used by `Truth_Table` for its bit-wise operations.
+ *
+ * Every kernel exists in a scalar version and, on x86-64 with GCC or Clang, in SSE2, AVX2 and
+ * AVX-512 versions compiled with the matching `target` attribute (so no special compiler flag
+ * is needed). The best version supported by the CPU is selected at run time by `word_kernels`.
+ * The result array may be the same as an input (in-place operations), but must not partially
+ * overlap it. */
+
+enum class Simd_Level
+{
+  scalar,
+  sse2,
+  avx2,
+  avx512
+};
+
+struct Word_Kernels
+{
+  Simd_Level level;
+  void ( *and_words )( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n );
+  void ( *or_words )( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n );
+  void ( *xor_words )( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n );
+  void ( *not_words )( uint64_t* r, uint64_t const* a, uint64_t n );
+  bool ( *equal_words )( uint64_t const* a, uint64_t const* b, uint64_t n );
+  uint64_t ( *popcount_words )( uint64_t const* a, uint64_t n );
+  /* r[i] = ( a[i] & mask ) | ( a[i] & mask ) >> shift (or << shift if `left`) */
+  void ( *spread_words )( uint64_t* r, uint64_t const* a, uint64_t n, uint64_t mask, uint32_t shift, bool left );
+};
+
+struct Scalar_Kernels
+{
+  static void and_words( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    for ( uint64_t i = 0u; i < n; ++i )
+    {
+      r[i] = a[i] & b[i];
+    }
+  }
+
+  static void or_words( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    for ( uint64_t i = 0u; i < n; ++i )
+    {
+      r[i] = a[i] | b[i];
+    }
+  }
+
+  static void xor_words( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    for ( uint64_t i = 0u; i < n; ++i )
+    {
+      r[i] = a[i] ^ b[i];
+    }
+  }
+
+  static void not_words( uint64_t* r, uint64_t const* a, uint64_t n )
+  {
+    for ( uint64_t i = 0u; i < n; ++i )
+    {
+      r[i] = ~a[i];
+    }
+  }
+
+  static bool equal_words( uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    return n == 0u || std::memcmp( a, b, n * sizeof( uint64_t ) ) == 0;
+  }
+
+  static uint64_t popcount_words( uint64_t const* a, uint64_t n )
+  {
+    uint64_t count = 0u;
+    for ( uint64_t i = 0u; i < n; ++i )
+    {
+      count += __builtin_popcountll( a[i] );
+    }
+    return count;
+  }
+
+  static void spread_words( uint64_t* r, uint64_t const* a, uint64_t n, uint64_t mask, uint32_t shift, bool left )
+  {
+    for ( uint64_t i = 0u; i < n; ++i )
+    {
+      uint64_t const w = a[i] & mask;
+      r[i] = w | ( left ? w << shift : w >> shift );
+    }
+  }
+};
+
+#ifdef BDD_SIMD_X86
+
+/* The vector loops leave the last `n % width` words to the scalar kernels. */
+struct Sse2_Kernels
+{
+  __attribute__( ( target( "sse2" ) ) ) static void and_words( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    uint64_t i = 0u;
+    for ( ; i + 2u <= n; i += 2u )
+    {
+      __m128i const x = _mm_loadu_si128( reinterpret_cast<__m128i const*>( a + i ) );
+      __m128i const y = _mm_loadu_si128( reinterpret_cast<__m128i const*>( b + i ) );
+      _mm_storeu_si128( reinterpret_cast<__m128i*>( r + i ), _mm_and_si128( x, y ) );
+    }
+    Scalar_Kernels::and_words( r + i, a + i, b + i, n - i );
+  }
+
+  __attribute__( ( target( "sse2" ) ) ) static void or_words( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    uint64_t i = 0u;
+    for ( ; i + 2u <= n; i += 2u )
+    {
+      __m128i const x = _mm_loadu_si128( reinterpret_cast<__m128i const*>( a + i ) );
+      __m128i const y = _mm_loadu_si128( reinterpret_cast<__m128i const*>( b + i ) );
+      _mm_storeu_si128( reinterpret_cast<__m128i*>( r + i ), _mm_or_si128( x, y ) );
+    }
+    Scalar_Kernels::or_words( r + i, a + i, b + i, n - i );
+  }
+
+  __attribute__( ( target( "sse2" ) ) ) static void xor_words( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    uint64_t i = 0u;
+    for ( ; i + 2u <= n; i += 2u )
+    {
+      __m128i const x = _mm_loadu_si128( reinterpret_cast<__m128i const*>( a + i ) );
+      __m128i const y = _mm_loadu_si128( reinterpret_cast<__m128i const*>( b + i ) );
+      _mm_storeu_si128( reinterpret_cast<__m128i*>( r + i ), _mm_xor_si128( x, y ) );
+    }
+    Scalar_Kernels::xor_words( r + i, a + i, b + i, n - i );
+  }
+
+  __attribute__( ( target( "sse2" ) ) ) static void not_words( uint64_t* r, uint64_t const* a, uint64_t n )
+  {
+    __m128i const ones = _mm_set1_epi32( -1 );
+    uint64_t i = 0u;
+    for ( ; i + 2u <= n; i += 2u )
+    {
+      __m128i const x = _mm_loadu_si128( reinterpret_cast<__m128i const*>( a + i ) );
+      _mm_storeu_si128( reinterpret_cast<__m128i*>( r + i ), _mm_xor_si128( x, ones ) );
+    }
+    Scalar_Kernels::not_words( r + i, a + i, n - i );
+  }
+
+  __attribute__( ( target( "sse2" ) ) ) static bool equal_words( uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    uint64_t i = 0u;
+    for ( ; i + 2u <= n; i += 2u )
+    {
+      __m128i const x = _mm_loadu_si128( reinterpret_cast<__m128i const*>( a + i ) );
+      __m128i const y = _mm_loadu_si128( reinterpret_cast<__m128i const*>( b + i ) );
+      if ( _mm_movemask_epi8( _mm_cmpeq_epi32( x, y ) ) != 0xffff )
+      {
+        return false;
+      }
+    }
+    return Scalar_Kernels::equal_words( a + i, b + i, n - i );
+  }
+
+  static uint64_t popcount_words( uint64_t const* a, uint64_t n )
+  {
+    return Scalar_Kernels::popcount_words( a, n );
+  }
+
+  __attribute__( ( target( "sse2" ) ) ) static void spread_words( uint64_t* r, uint64_t const* a, uint64_t n, uint64_t mask, uint32_t shift, bool left )
+  {
+    __m128i const m = _mm_set1_epi64x( mask );
+    __m128i const s = _mm_cvtsi32_si128( shift );
+    uint64_t i = 0u;
+    for ( ; i + 2u <= n; i += 2u )
+    {
+      __m128i const x = _mm_and_si128( _mm_loadu_si128( reinterpret_cast<__m128i const*>( a + i ) ), m );
+      __m128i const y = left ? _mm_sll_epi64( x, s ) : _mm_srl_epi64( x, s );
+      _mm_storeu_si128( reinterpret_cast<__m128i*>( r + i ), _mm_or_si128( x, y ) );
+    }
+    Scalar_Kernels::spread_words( r + i, a + i, n - i, mask, shift, left );
+  }
+};
+
+struct Avx2_Kernels
+{
+  __attribute__( ( target( "avx2" ) ) ) static void and_words( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    uint64_t i = 0u;
+    for ( ; i + 4u <= n; i += 4u )
+    {
+      __m256i const x = _mm256_loadu_si256( reinterpret_cast<__m256i const*>( a + i ) );
+      __m256i const y = _mm256_loadu_si256( reinterpret_cast<__m256i const*>( b + i ) );
+      _mm256_storeu_si256( reinterpret_cast<__m256i*>( r + i ), _mm256_and_si256( x, y ) );
+    }
+    Scalar_Kernels::and_words( r + i, a + i, b + i, n - i );
+  }
+
+  __attribute__( ( target( "avx2" ) ) ) static void or_words( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    uint64_t i = 0u;
+    for ( ; i + 4u <= n; i += 4u )
+    {
+      __m256i const x = _mm256_loadu_si256( reinterpret_cast<__m256i const*>( a + i ) );
+      __m256i const y = _mm256_loadu_si256( reinterpret_cast<__m256i const*>( b + i ) );
+      _mm256_storeu_si256( reinterpret_cast<__m256i*>( r + i ), _mm256_or_si256( x, y ) );
+    }
+    Scalar_Kernels::or_words( r + i, a + i, b + i, n - i );
+  }
+
+  __attribute__( ( target( "avx2" ) ) ) static void xor_words( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    uint64_t i = 0u;
+    for ( ; i + 4u <= n; i += 4u )
+    {
+      __m256i const x = _mm256_loadu_si256( reinterpret_cast<__m256i const*>( a + i ) );
+      __m256i const y = _mm256_loadu_si256( reinterpret_cast<__m256i const*>( b + i ) );
+      _mm256_storeu_si256( reinterpret_cast<__m256i*>( r + i ), _mm256_xor_si256( x, y ) );
+    }
+    Scalar_Kernels::xor_words( r + i, a + i, b + i, n - i );
+  }
+
+  __attribute__( ( target( "avx2" ) ) ) static void not_words( uint64_t* r, uint64_t const* a, uint64_t n )
+  {
+    __m256i const ones = _mm256_set1_epi32( -1 );
+    uint64_t i = 0u;
+    for ( ; i + 4u <= n; i += 4u )
+    {
+      __m256i const x = _mm256_loadu_si256( reinterpret_cast<__m256i const*>( a + i ) );
+      _mm256_storeu_si256( reinterpret_cast<__m256i*>( r + i ), _mm256_xor_si256( x, ones ) );
+    }
+    Scalar_Kernels::not_words( r + i, a + i, n - i );
+  }
+
+  __attribute__( ( target( "avx2" ) ) ) static bool equal_words( uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    uint64_t i = 0u;
+    for ( ; i + 4u <= n; i += 4u )
+    {
+      __m256i const x = _mm256_loadu_si256( reinterpret_cast<__m256i const*>( a + i ) );
+      __m256i const y = _mm256_loadu_si256( reinterpret_cast<__m256i const*>( b + i ) );
+      __m256i const d = _mm256_xor_si256( x, y );
+      if ( !_mm256_testz_si256( d, d ) )
+      {
+        return false;
+      }
+    }
+    return Scalar_Kernels::equal_words( a + i, b + i, n - i );
+  }
+
+  /* The hardware `popcnt` instruction, four words per iteration for instruction-level parallelism. */
+  __attribute__( ( target( "avx2,popcnt" ) ) ) static uint64_t popcount_words( uint64_t const* a, uint64_t n )
+  {
+    uint64_t c0 = 0u, c1 = 0u, c2 = 0u, c3 = 0u;
+    uint64_t i = 0u;
+    for ( ; i + 4u <= n; i += 4u )
+    {
+      c0 += _mm_popcnt_u64( a[i] );
+      c1 += _mm_popcnt_u64( a[i + 1u] );
+      c2 += _mm_popcnt_u64( a[i + 2u] );
+      c3 += _mm_popcnt_u64( a[i + 3u] );
+    }
+    for ( ; i < n; ++i )
+    {
+      c0 += _mm_popcnt_u64( a[i] );
+    }
+    return c0 + c1 + c2 + c3;
+  }
+
+  __attribute__( ( target( "avx2" ) ) ) static void spread_words( uint64_t* r, uint64_t const* a, uint64_t n, uint64_t mask, uint32_t shift, bool left )
+  {
+    __m256i const m = _mm256_set1_epi64x( mask );
+    __m128i const s = _mm_cvtsi32_si128( shift );
+    uint64_t i = 0u;
+    for ( ; i + 4u <= n; i += 4u )
+    {
+      __m256i const x = _mm256_and_si256( _mm256_loadu_si256( reinterpret_cast<__m256i const*>( a + i ) ), m );
+      __m256i const y = left ? _mm256_sll_epi64( x, s ) : _mm256_srl_epi64( x, s );
+      _mm256_storeu_si256( reinterpret_cast<__m256i*>( r + i ), _mm256_or_si256( x, y ) );
+    }
+    Scalar_Kernels::spread_words( r + i, a + i, n - i, mask, shift, left );
+  }
+};
+
+struct Avx512_Kernels
+{
+  __attribute__( ( target( "avx512f" ) ) ) static void and_words( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    uint64_t i = 0u;
+    for ( ; i + 8u <= n; i += 8u )
+    {
+      _mm512_storeu_si512( r + i, _mm512_and_si512( _mm512_loadu_si512( a + i ), _mm512_loadu_si512( b + i ) ) );
+    }
+    Avx2_Kernels::and_words( r + i, a + i, b + i, n - i );
+  }
+
+  __attribute__( ( target( "avx512f" ) ) ) static void or_words( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    uint64_t i = 0u;
+    for ( ; i + 8u <= n; i += 8u )
+    {
+      _mm512_storeu_si512( r + i, _mm512_or_si512( _mm512_loadu_si512( a + i ), _mm512_loadu_si512( b + i ) ) );
+    }
+    Avx2_Kernels::or_words( r + i, a + i, b + i, n - i );
+  }
+
+  __attribute__( ( target( "avx512f" ) ) ) static void xor_words( uint64_t* r, uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    uint64_t i = 0u;
+    for ( ; i + 8u <= n; i += 8u )
+    {
+      _mm512_storeu_si512( r + i, _mm512_xor_si512( _mm512_loadu_si512( a + i ), _mm512_loadu_si512( b + i ) ) );
+    }
+    Avx2_Kernels::xor_words( r + i, a + i, b + i, n - i );
+  }
+
+  __attribute__( ( target( "avx512f" ) ) ) static void not_words( uint64_t* r, uint64_t const* a, uint64_t n )
+  {
+    __m512i const ones = _mm512_set1_epi64( -1 );
+    uint64_t i = 0u;
+    for ( ; i + 8u <= n; i += 8u )
+    {
+      _mm512_storeu_si512( r + i, _mm512_xor_si512( _mm512_loadu_si512( a + i ), ones ) );
+    }
+    Avx2_Kernels::not_words( r + i, a + i, n - i );
+  }
+
+  __attribute__( ( target( "avx512f" ) ) ) static bool equal_words( uint64_t const* a, uint64_t const* b, uint64_t n )
+  {
+    uint64_t i = 0u;
+    for ( ; i + 8u <= n; i += 8u )
+    {
+      if ( _mm512_cmpneq_epi64_mask( _mm512_loadu_si512( a + i ), _mm512_loadu_si512( b + i ) ) != 0 )
+      {
+        return false;
+      }
+    }
+    return Avx2_Kernels::equal_words( a + i, b + i, n - i );
+  }
+
+  static uint64_t popcount_words( uint64_t const* a, uint64_t n )
+  {
+    return Avx2_Kernels::popcount_words( a, n );
+  }
+
+  __attribute__( ( target( "avx512f" ) ) ) static void spread_words( uint64_t* r, uint64_t const* a, uint64_t n, uint64_t mask, uint32_t shift, bool left )
+  {
+    __m512i const m = _mm512_set1_epi64( mask );
+    __m128i const s = _mm_cvtsi32_si128( shift );
+    uint64_t i = 0u;
+    for ( ; i + 8u <= n; i += 8u )
+    {
+      __m512i const x = _mm512_and_si512( _mm512_loadu_si512( a + i ), m );
+      __m512i const y = left ? _mm512_sll_epi64( x, s ) : _mm512_srl_epi64( x, s );
+      _mm512_storeu_si512( r + i, _mm512_or_si512( x, y ) );
+    }
+    Avx2_Kernels::spread_words( r + i, a + i, n - i, mask, shift, left );
+  }
+};
+
+#endif
+
+template<typename Kernels>
+inline Word_Kernels make_word_kernels( Simd_Level level )
+{
+  return Word_Kernels( {level, &Kernels::and_words, &Kernels::or_words, &Kernels::xor_words, &Kernels::not_words,
+                        &Kernels::equal_words, &Kernels::popcount_words, &Kernels::spread_words} );
+}
+
+/* The most capable level supported by the CPU. */
+inline Simd_Level best_simd_level()
+{
+#ifdef BDD_SIMD_X86
+  __builtin_cpu_init();
+  if ( __builtin_cpu_supports( "avx512f" ) )
+  {
+    return Simd_Level::avx512;
+  }
+  if ( __builtin_cpu_supports( "avx2" ) && __builtin_cpu_supports( "popcnt" ) )
+  {
+    return Simd_Level::avx2;
+  }
+  if ( __builtin_cpu_supports( "sse2" ) )
+  {
+    return Simd_Level::sse2;
+  }
+#endif
+  return Simd_Level::scalar;
+}
+
+inline Word_Kernels word_kernels_of( Simd_Level level )
+{
+  switch ( level )
+  {
+#ifdef BDD_SIMD_X86
+  case Simd_Level::avx512:
+    return make_word_kernels<Avx512_Kernels>( level );
+  case Simd_Level::avx2:
+    return make_word_kernels<Avx2_Kernels>( level );
+  case Simd_Level::sse2:
+    return make_word_kernels<Sse2_Kernels>( level );
+#endif
+  default:
+    return make_word_kernels<Scalar_Kernels>( Simd_Level::scalar );
+  }
+}
+
+inline Word_Kernels& current_word_kernels()
+{
+  static Word_Kernels kernels = word_kernels_of( best_simd_level() );
+  return kernels;
+}
+
+/* The kernels in use, initially the ones of `best_simd_level()`. */
+inline Word_Kernels const& word_kernels()
+{
+  return current_word_kernels();
+}
+
+/* Use the kernels of `level` from now on (e.g., to compare the versions). Returns false,
+ * changing nothing, if the CPU does not support it. Not thread-safe. */
+inline bool set_simd_level( Simd_Level level )
+{
+  if ( level > best_simd_level() )
+  {
+    return false;
+  }
+  current_word_kernels() = word_kernels_of( level );
+  return true;
+}
+
+/* A block of 512 bits, e.g., 512 input patterns of one variable for `BDD::evaluate`. */
+struct Word512
+{
+  uint64_t w[8];
+};
+
+/* The multiplexer x ? t : e on every bit, with `t` and `e` first complemented by XOR with
+ * `t_mask` and `e_mask`. */
+inline uint64_t mux( uint64_t x, uint64_t t, uint64_t t_mask, uint64_t e, uint64_t e_mask )
+{
+  return ( x & ( t ^ t_mask ) ) | ( ~x & ( e ^ e_mask ) );
+}
+
+inline Word512 mux( Word512 const& x, Word512 const& t, uint64_t t_mask, Word512 const& e, uint64_t e_mask )
+{
+  Word512 r;
+  for ( auto i = 0u; i < 8u; ++i )
+  {
+    r.w[i] = mux( x.w[i], t.w[i], t_mask, e.w[i], e_mask );
+  }
+  return r;
+}
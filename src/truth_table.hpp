@@ -1,7 +1,11 @@
 #pragma once
 
+#include "simd_kernels.hpp"
+
+#include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -56,27 +60,40 @@ class Truth_Table
 {
 public:
     Truth_Table( uint8_t num_var )
-    : num_var( num_var ), bit_size(1<<num_var), bits(bit_size, false)
+    : num_var( num_var ), bit_size( uint64_t( 1 ) << num_var ), bits( num_words( num_var ), 0u )
     {
-        //assert( num_var <= 6u );
     }
     
     Truth_Table( uint8_t num_var, uint64_t bits )
-    : num_var( num_var ), bit_size(1<<num_var)
+    : num_var( num_var ), bit_size( uint64_t( 1 ) << num_var ), bits( 1u, bits & length_mask[num_var] )
     {
         assert( num_var <= 6u );
-        for (unsigned i = 1; i<=bit_size; i+=1) {
-            this->bits.push_back((bits>>(bit_size-i))&1);
+    }
+    
+    /* `bits` lists the bits from the last position to position 0, as printed */
+    Truth_Table( uint8_t num_var, std::vector<bool> const& bits )
+    : num_var( num_var ), bit_size( bits.size() ), bits( num_words( num_var ), 0u )
+    {
+        assert( bit_size == ( uint64_t( 1 ) << num_var ) );
+        for ( auto i = 0u; i < bit_size; ++i )
+        {
+            if ( bits[i] )
+            {
+                set_bit( bit_size - i - 1 );
+            }
         }
     }
     
-    Truth_Table( uint8_t num_var, std::vector<bool> bits )
-    : num_var( num_var ), bit_size(bits.size()), bits(bits)
+    /* `words` holds the bits packed by 64, position 0 being the lowest bit of the first word */
+    Truth_Table( uint8_t num_var, std::vector<uint64_t> words )
+    : num_var( num_var ), bit_size( uint64_t( 1 ) << num_var ), bits( std::move( words ) )
     {
+        assert( bits.size() == num_words( num_var ) );
+        mask_bits();
     }
     
     Truth_Table( const std::string str )
-    : bit_size(str.size()), num_var( power_two( str.size() ) )
+    : num_var( power_two( str.size() ) ), bit_size( str.size() ), bits( num_words( num_var ), 0u )
     {
         if ( num_var == 0u )
         {
@@ -86,20 +103,23 @@ public:
         for ( auto i = 0u; i < str.size(); ++i )
         {
             assert( str[i] == '1' || str[i] == '0' );
-            bits.push_back(str[i] == '1');
+            if ( str[i] == '1' )
+            {
+                set_bit( bit_size - i - 1 );
+            }
         }
     }
     
-    bool get_bit( uint8_t const position ) const
+    bool get_bit( uint64_t const position ) const
     {
         assert( position < ( bit_size ) );
-        return bits[bit_size - position - 1];
+        return ( bits[position >> 6] >> ( position & 63u ) ) & 1u;
     }
     
-    void set_bit( uint8_t const position )
+    void set_bit( uint64_t const position )
     {
         assert( position < ( bit_size ) );
-        bits[bit_size - position - 1] = true;
+        bits[position >> 6] |= uint64_t( 1 ) << ( position & 63u );
     }
     
     uint8_t n_var() const
@@ -107,22 +127,74 @@ public:
         return num_var;
     }
     
+    /* in-place bit-wise operations */
+    Truth_Table& operator&=( Truth_Table const& other )
+    {
+        assert( num_var == other.num_var );
+        word_kernels().and_words( bits.data(), bits.data(), other.bits.data(), bits.size() );
+        return *this;
+    }
+    
+    Truth_Table& operator|=( Truth_Table const& other )
+    {
+        assert( num_var == other.num_var );
+        word_kernels().or_words( bits.data(), bits.data(), other.bits.data(), bits.size() );
+        return *this;
+    }
+    
+    Truth_Table& operator^=( Truth_Table const& other )
+    {
+        assert( num_var == other.num_var );
+        word_kernels().xor_words( bits.data(), bits.data(), other.bits.data(), bits.size() );
+        return *this;
+    }
+    
+    /* number of positions where the function is 1 */
+    uint64_t count_ones() const
+    {
+        return word_kernels().popcount_words( bits.data(), bits.size() );
+    }
+    
+    /* exchange the roles of variables `var1` and `var2` */
+    void swap_vars( uint8_t const var1, uint8_t const var2 )
+    {
+        assert( var1 < num_var && var2 < num_var );
+        swap_vars( bits.data(), num_var, var1, var2 );
+    }
+    
+    static void swap_vars( uint64_t* words, uint8_t const num_var, uint8_t var1, uint8_t var2 );
+    
     Truth_Table positive_cofactor( uint8_t const var ) const;
     Truth_Table negative_cofactor( uint8_t const var ) const;
     Truth_Table derivative( uint8_t const var ) const;
     Truth_Table consensus( uint8_t const var ) const;
     Truth_Table smoothing( uint8_t const var ) const;
     
+    /* number of 64-bit words storing a truth table over `num_var` variables */
+    static uint64_t num_words( uint8_t const num_var )
+    {
+        return num_var <= 6u ? 1u : ( uint64_t( 1 ) << ( num_var - 6u ) );
+    }
+    
+    /* clear the unused bits of a table with less than 6 variables */
+    void mask_bits()
+    {
+        if ( num_var < 6u )
+        {
+            bits[0] &= length_mask[num_var];
+        }
+    }
+    
 public:
     uint8_t const num_var; /* number of variables involved in the function */
     uint64_t const bit_size;
-    std::vector<bool> bits; /* the truth table */
+    std::vector<uint64_t> bits; /* the truth table, packed by 64 bits (unused bits are 0) */
 };
 
 /* overload std::ostream operator for convenient printing */
 inline std::ostream& operator<<( std::ostream& os, Truth_Table const& tt )
 {
-    for ( int8_t i = ( 1 << tt.num_var ) - 1; i >= 0; --i )
+    for ( uint64_t i = tt.bit_size; i-- > 0u; )
     {
         os << ( tt.get_bit( i ) ? '1' : '0' );
     }
@@ -132,44 +204,36 @@ inline std::ostream& operator<<( std::ostream& os, Truth_Table const& tt )
 /* bit-wise NOT operation */
 inline Truth_Table operator~( Truth_Table const& tt )
 {
-    std::vector<bool> opposite;
-    for (auto const value : tt.bits) {
-        opposite.push_back(!value);
-    }
-    return Truth_Table( tt.num_var, opposite );
+    std::vector<uint64_t> opposite( tt.bits.size() );
+    word_kernels().not_words( opposite.data(), tt.bits.data(), tt.bits.size() );
+    return Truth_Table( tt.num_var, std::move( opposite ) );
 }
 
 /* bit-wise OR operation */
 inline Truth_Table operator|( Truth_Table const& tt1, Truth_Table const& tt2 )
 {
     assert( tt1.num_var == tt2.num_var );
-    std::vector<bool> conjunction;
-    for (auto i = 0u; i<tt1.bit_size; i+=1) {
-        conjunction.push_back(tt1.bits[i] || tt2.bits[i]);
-    }
-    return Truth_Table( tt1.num_var, conjunction );
+    std::vector<uint64_t> disjunction( tt1.bits.size() );
+    word_kernels().or_words( disjunction.data(), tt1.bits.data(), tt2.bits.data(), tt1.bits.size() );
+    return Truth_Table( tt1.num_var, std::move( disjunction ) );
 }
 
 /* bit-wise AND operation */
 inline Truth_Table operator&( Truth_Table const& tt1, Truth_Table const& tt2 )
 {
     assert( tt1.num_var == tt2.num_var );
-    std::vector<bool> conjunction;
-    for (auto i = 0u; i<tt1.bit_size; i+=1) {
-        conjunction.push_back(tt1.bits[i] && tt2.bits[i]);
-    }
-    return Truth_Table( tt1.num_var, conjunction );
+    std::vector<uint64_t> conjunction( tt1.bits.size() );
+    word_kernels().and_words( conjunction.data(), tt1.bits.data(), tt2.bits.data(), tt1.bits.size() );
+    return Truth_Table( tt1.num_var, std::move( conjunction ) );
 }
 
 /* bit-wise XOR operation */
 inline Truth_Table operator^( Truth_Table const& tt1, Truth_Table const& tt2 )
 {
     assert( tt1.num_var == tt2.num_var );
-    std::vector<bool> conjunction;
-    for (auto i = 0u; i<tt1.bit_size; i+=1) {
-        conjunction.push_back(tt1.bits[i] ^ tt2.bits[i]);
-    }
-    return Truth_Table( tt1.num_var, conjunction );
+    std::vector<uint64_t> difference( tt1.bits.size() );
+    word_kernels().xor_words( difference.data(), tt1.bits.data(), tt2.bits.data(), tt1.bits.size() );
+    return Truth_Table( tt1.num_var, std::move( difference ) );
 }
 
 /* check if two truth_tables are the same */
@@ -179,7 +243,7 @@ inline bool operator==( Truth_Table const& tt1, Truth_Table const& tt2 )
     {
         return false;
     }
-    return tt1.bits == tt2.bits;
+    return word_kernels().equal_words( tt1.bits.data(), tt2.bits.data(), tt1.bits.size() );
 }
 
 inline bool operator!=( Truth_Table const& tt1, Truth_Table const& tt2 )
@@ -187,38 +251,101 @@ inline bool operator!=( Truth_Table const& tt1, Truth_Table const& tt2 )
     return !( tt1 == tt2 );
 }
 
+/* Variables below 6 are cofactored inside each word with the masks: the bits where `var` is 1 (0)
+ * are copied onto their neighbors where it is 0 (1). Higher variables select whole words:
+ * each block of words where `var` is 1 (0) is copied onto the adjacent block where it is 0 (1). */
 inline Truth_Table Truth_Table::positive_cofactor( uint8_t const var ) const
 {
     assert( var < num_var );
-    std::vector<bool> cofactor;
-    auto step = 1<<var;
-    auto i = 0u;
-    while (i<bit_size) {
-        for (auto twice = 0u; twice < 2; twice += 1) {  // Do it twice
-            for (auto j = 0u; j<step; j+=1) {
-                cofactor.push_back(bits[i+j]);
-            }
+    std::vector<uint64_t> cofactor( bits.size() );
+    if ( var < 6u )
+    {
+        word_kernels().spread_words( cofactor.data(), bits.data(), bits.size(), var_mask_pos[var], 1u << var, false );
+    }
+    else
+    {
+        auto const step = uint64_t( 1 ) << ( var - 6u );
+        for ( auto i = 0u; i < bits.size(); i += 2 * step )
+        {
+            std::copy( bits.begin() + i + step, bits.begin() + i + 2 * step, cofactor.begin() + i );
+            std::copy( bits.begin() + i + step, bits.begin() + i + 2 * step, cofactor.begin() + i + step );
         }
-        i += 2*step;
     }
-    return Truth_Table( num_var, cofactor );
+    return Truth_Table( num_var, std::move( cofactor ) );
 }
 
 inline Truth_Table Truth_Table::negative_cofactor( uint8_t const var ) const
 {
     assert( var < num_var );
-    std::vector<bool> cofactor;
-    auto step = 1<<var;
-    auto i = 0u;
-    while (i<bit_size) {
-        for (auto twice = 0u; twice < 2; twice += 1) {  // Do it twice
-            for (auto j = 0u; j<step; j+=1) {
-                cofactor.push_back(bits[i+j+step]);
+    std::vector<uint64_t> cofactor( bits.size() );
+    if ( var < 6u )
+    {
+        word_kernels().spread_words( cofactor.data(), bits.data(), bits.size(), var_mask_neg[var], 1u << var, true );
+    }
+    else
+    {
+        auto const step = uint64_t( 1 ) << ( var - 6u );
+        for ( auto i = 0u; i < bits.size(); i += 2 * step )
+        {
+            std::copy( bits.begin() + i, bits.begin() + i + step, cofactor.begin() + i );
+            std::copy( bits.begin() + i, bits.begin() + i + step, cofactor.begin() + i + step );
+        }
+    }
+    return Truth_Table( num_var, std::move( cofactor ) );
+}
+
+/* Swapping two variables exchanges the bits at the positions where one is 1 and the other 0.
+ * These are delta swaps inside the words, between pairs of words or between blocks of words,
+ * depending on how many of the two variables are below 6. */
+inline void Truth_Table::swap_vars( uint64_t* words, uint8_t const num_var, uint8_t var1, uint8_t var2 )
+{
+    if ( var1 == var2 )
+    {
+        return;
+    }
+    if ( var1 > var2 )
+    {
+        std::swap( var1, var2 );
+    }
+    uint64_t const size = num_words( num_var );
+    if ( var2 < 6u )
+    {
+        /* positions with var1 = 1, var2 = 0 and their partners `delta` above */
+        uint64_t const mask = var_mask_pos[var1] & var_mask_neg[var2];
+        uint32_t const delta = ( 1u << var2 ) - ( 1u << var1 );
+        for ( auto i = 0u; i < size; ++i )
+        {
+            uint64_t const t = ( words[i] ^ ( words[i] >> delta ) ) & mask;
+            words[i] ^= t ^ ( t << delta );
+        }
+    }
+    else if ( var1 < 6u )
+    {
+        /* in words where var2 = 0, the bits with var1 = 1, and their partners in the word where var2 = 1 */
+        uint64_t const step = uint64_t( 1 ) << ( var2 - 6u );
+        uint32_t const shift = 1u << var1;
+        for ( uint64_t i = 0u; i < size; i += 2 * step )
+        {
+            for ( auto j = i; j < i + step; ++j )
+            {
+                uint64_t const t = ( ( words[j] >> shift ) ^ words[j + step] ) & var_mask_neg[var1];
+                words[j + step] ^= t;
+                words[j] ^= t << shift;
+            }
+        }
+    }
+    else
+    {
+        /* words where var1 = 1, var2 = 0 and their partners */
+        uint64_t const step1 = uint64_t( 1 ) << ( var1 - 6u ), step2 = uint64_t( 1 ) << ( var2 - 6u );
+        for ( uint64_t i = 0u; i < size; ++i )
+        {
+            if ( ( i & step1 ) && !( i & step2 ) )
+            {
+                std::swap( words[i], words[i - step1 + step2] );
             }
         }
-        i += 2*step;
     }
-    return Truth_Table( num_var, cofactor );
 }
 
 inline Truth_Table Truth_Table::derivative( uint8_t const var ) const
@@ -244,18 +371,166 @@ inline Truth_Table create_tt_nth_var( uint8_t const num_var, uint8_t const var,
 {
     assert ( var < num_var );
     
-    std::vector<bool> cofactor;
-    auto step = 1<<var;
-    auto i = 0u;
-    while (i<(1<<num_var)) {
-        for (auto j = 0u; j<step; j+=1) {
-            cofactor.push_back(polarity);
-        }
-        for (auto j = 0u; j<step; j+=1) {
-            cofactor.push_back(!polarity);
-        }
-        i += 2*step;
+    std::vector<uint64_t> words( Truth_Table::num_words( num_var ) );
+    for ( auto i = 0u; i < words.size(); ++i )
+    {
+        bool const value = var < 6u || ( ( i >> ( var - 6u ) ) & 1u );
+        uint64_t const word = var < 6u ? var_mask_pos[var] : ( value ? ~uint64_t( 0 ) : 0u );
+        words[i] = polarity ? word : ~word;
     }
     
-    return Truth_Table( num_var, cofactor );
+    return Truth_Table( num_var, std::move( words ) );
+}
+
+/* A cube (a conjunction of literals) over at most 64 variables, packed in two words:
+ * variable `i` appears in the cube if bit `i` of `mask` is set, positively if bit `i` of `polarity` is set too. */
+struct Packed_Cube
+{
+    uint64_t mask;
+    uint64_t polarity;
+};
+
+/* Minato-Morreale ISOP of the interval [lower, upper] over the variables below `num_var <= 6`,
+ * held in the low 2^num_var bits of the words: appends the cubes of the cover to `cubes` and
+ * returns the cover. Splitting on the highest variable halves the words. */
+inline uint64_t isop_word( uint64_t const lower, uint64_t const upper, uint8_t const num_var, std::vector<Packed_Cube>& cubes )
+{
+    uint64_t const all = length_mask[num_var];
+    if ( ( lower & all ) == 0u )
+    {
+        return 0u;
+    }
+    if ( ( upper & all ) == all )
+    {
+        cubes.push_back( Packed_Cube( {0u, 0u} ) );
+        return all;
+    }
+
+    uint8_t const var = num_var - 1u;
+    uint32_t const shift = 1u << var;
+    uint64_t const half = length_mask[var];
+    uint64_t const lower0 = lower & half, lower1 = ( lower >> shift ) & half;
+    uint64_t const upper0 = upper & half, upper1 = ( upper >> shift ) & half;
+    if ( lower0 == lower1 && upper0 == upper1 )
+    {
+        uint64_t const cover = isop_word( lower0, upper0, var, cubes );
+        return cover | ( cover << shift );
+    }
+
+    /* the cubes with ~var, then with var, then without var */
+    auto begin = cubes.size();
+    uint64_t const cover0 = isop_word( lower0 & ~upper1, upper0, var, cubes );
+    for ( auto i = begin; i < cubes.size(); ++i )
+    {
+        cubes[i].mask |= uint64_t( 1 ) << var;
+    }
+    begin = cubes.size();
+    uint64_t const cover1 = isop_word( lower1 & ~upper0, upper1, var, cubes );
+    for ( auto i = begin; i < cubes.size(); ++i )
+    {
+        cubes[i].mask |= uint64_t( 1 ) << var;
+        cubes[i].polarity |= uint64_t( 1 ) << var;
+    }
+    uint64_t const rest = isop_word( ( lower0 & ~cover0 ) | ( lower1 & ~cover1 ), upper0 & upper1, var, cubes );
+    return ( cover0 | rest ) | ( ( cover1 | rest ) << shift );
+}
+
+/* Same as `isop_word` for `num_var > 6`, with the tables held in `num_words( num_var )` words
+ * each. Splitting on the highest variable halves the arrays of words. */
+inline void isop_words( uint64_t const* lower, uint64_t const* upper, uint64_t* cover, uint8_t const num_var, std::vector<Packed_Cube>& cubes )
+{
+    if ( num_var <= 6u )
+    {
+        cover[0] = isop_word( lower[0], upper[0], num_var, cubes );
+        return;
+    }
+    uint64_t const size = Truth_Table::num_words( num_var );
+    if ( std::all_of( lower, lower + size, []( uint64_t w ) { return w == 0u; } ) )
+    {
+        std::fill( cover, cover + size, 0u );
+        return;
+    }
+    if ( std::all_of( upper, upper + size, []( uint64_t w ) { return w == ~uint64_t( 0 ); } ) )
+    {
+        cubes.push_back( Packed_Cube( {0u, 0u} ) );
+        std::fill( cover, cover + size, ~uint64_t( 0 ) );
+        return;
+    }
+
+    uint8_t const var = num_var - 1u;
+    uint64_t const half = size / 2u;
+    uint64_t const *lower0 = lower, *lower1 = lower + half, *upper0 = upper, *upper1 = upper + half;
+    if ( std::equal( lower0, lower0 + half, lower1 ) && std::equal( upper0, upper0 + half, upper1 ) )
+    {
+        isop_words( lower0, upper0, cover, var, cubes );
+        std::copy( cover, cover + half, cover + half );
+        return;
+    }
+
+    /* the cubes with ~var, then with var, then without var */
+    std::vector<uint64_t> scratch( 3u * half );
+    uint64_t *l = scratch.data(), *u = l + half, *rest = u + half;
+    for ( auto i = 0u; i < half; ++i )
+    {
+        l[i] = lower0[i] & ~upper1[i];
+    }
+    auto begin = cubes.size();
+    isop_words( l, upper0, cover, var, cubes );
+    for ( auto i = begin; i < cubes.size(); ++i )
+    {
+        cubes[i].mask |= uint64_t( 1 ) << var;
+    }
+    for ( auto i = 0u; i < half; ++i )
+    {
+        l[i] = lower1[i] & ~upper0[i];
+    }
+    begin = cubes.size();
+    isop_words( l, upper1, cover + half, var, cubes );
+    for ( auto i = begin; i < cubes.size(); ++i )
+    {
+        cubes[i].mask |= uint64_t( 1 ) << var;
+        cubes[i].polarity |= uint64_t( 1 ) << var;
+    }
+    for ( auto i = 0u; i < half; ++i )
+    {
+        l[i] = ( lower0[i] & ~cover[i] ) | ( lower1[i] & ~cover[half + i] );
+        u[i] = upper0[i] & upper1[i];
+    }
+    isop_words( l, u, rest, var, cubes );
+    for ( auto i = 0u; i < half; ++i )
+    {
+        cover[i] |= rest[i];
+        cover[half + i] |= rest[i];
+    }
+}
+
+/* Returns the cubes of the irredundant sum-of-products cover of Minato and Morreale of a function
+ * in the interval [lower, upper] (`lower` must imply `upper`): every cube is an implicant of
+ * `upper`, the cubes cover `lower`, and no cube can be removed. Their number is the size of the cover. */
+inline std::vector<Packed_Cube> isop( Truth_Table const& lower, Truth_Table const& upper )
+{
+    assert( lower.num_var == upper.num_var && lower.num_var <= 64u );
+    std::vector<Packed_Cube> cubes;
+    std::vector<uint64_t> cover( lower.bits.size() );
+    isop_words( lower.bits.data(), upper.bits.data(), cover.data(), lower.num_var, cubes );
+    return cubes;
+}
+
+/* Returns the truth table of the sum of products of `cubes` over `num_var` variables. */
+inline Truth_Table cubes_to_tt( std::vector<Packed_Cube> const& cubes, uint8_t const num_var )
+{
+    Truth_Table tt( num_var );
+    for ( auto const& cube : cubes )
+    {
+        Truth_Table product = ~Truth_Table( num_var );
+        for ( auto var = 0u; var < num_var; ++var )
+        {
+            if ( ( cube.mask >> var ) & 1u )
+            {
+                product &= create_tt_nth_var( num_var, var, ( cube.polarity >> var ) & 1u );
+            }
+        }
+        tt |= product;
+    }
+    return tt;
 }
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/* A fork-join thread pool with work stealing.
+ *
+ * `run` executes a root function on the calling thread, which becomes worker 0, while the
+ * other workers wait for tasks to steal. Inside it, `spawn` pushes a task to the deque of the
+ * current worker and `sync` waits for it: a task nobody stole is popped and run inline,
+ * otherwise the waiting worker steals and runs other tasks until it is done.
+ * Tasks must be synced in the reverse order of spawning (i.e., strict fork-join nesting). */
+class Work_Stealing_Pool
+{
+public:
+  class Task
+  {
+  public:
+    Task() : done( false ) {}
+
+  private:
+    friend class Work_Stealing_Pool;
+    std::function<void()> fn;
+    std::atomic<bool> done;
+  };
+
+  /* `num_threads` is the total number of workers, including the thread calling `run`. */
+  explicit Work_Stealing_Pool( uint32_t num_threads )
+    : active( false ), stop( false )
+  {
+    for ( auto i = 0u; i < std::max( num_threads, 1u ); ++i )
+    {
+      deques.emplace_back( new Deque() );
+    }
+    for ( auto i = 1u; i < deques.size(); ++i )
+    {
+      threads.emplace_back( [this, i]() { work( i ); } );
+    }
+  }
+
+  ~Work_Stealing_Pool()
+  {
+    {
+      std::lock_guard<std::mutex> lock( state_mutex );
+      stop = true;
+    }
+    wake_up.notify_all();
+    for ( auto& thread : threads )
+    {
+      thread.join();
+    }
+  }
+
+  Work_Stealing_Pool( Work_Stealing_Pool const& ) = delete;
+  Work_Stealing_Pool& operator=( Work_Stealing_Pool const& ) = delete;
+
+  uint32_t num_threads() const
+  {
+    return deques.size();
+  }
+
+  /* Index of the calling worker, in [0, num_threads). Only meaningful inside `run`. */
+  uint32_t worker_id() const
+  {
+    return current_worker();
+  }
+
+  /* Run `fn` on the calling thread with the help of the other workers. */
+  void run( std::function<void()> const& fn )
+  {
+    uint32_t const saved = current_worker();
+    current_worker() = 0u;
+    {
+      std::lock_guard<std::mutex> lock( state_mutex );
+      active.store( true, std::memory_order_release );
+    }
+    wake_up.notify_all();
+
+    fn();
+
+    active.store( false, std::memory_order_release );
+    current_worker() = saved;
+  }
+
+  /* Make `fn` available to the other workers as `task`. */
+  void spawn( Task& task, std::function<void()> fn )
+  {
+    task.fn = std::move( fn );
+    task.done.store( false, std::memory_order_relaxed );
+    Deque& own = *deques[current_worker()];
+    std::lock_guard<std::mutex> lock( own.mutex );
+    own.tasks.push_back( &task );
+  }
+
+  /* Wait until `task` is done. */
+  void sync( Task& task )
+  {
+    Deque& own = *deques[current_worker()];
+    bool stolen = true;
+    {
+      std::lock_guard<std::mutex> lock( own.mutex );
+      if ( !own.tasks.empty() && own.tasks.back() == &task )
+      {
+        own.tasks.pop_back();
+        stolen = false;
+      }
+    }
+    if ( !stolen )
+    {
+      /* Nobody stole it: run it inline. */
+      execute( task );
+      return;
+    }
+
+    /* Help the others until the thief is done. */
+    while ( !task.done.load( std::memory_order_acquire ) )
+    {
+      if ( Task* other = steal( current_worker() ) )
+      {
+        execute( *other );
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+private:
+  struct Deque
+  {
+    std::mutex mutex;
+    std::deque<Task*> tasks;
+  };
+
+  static uint32_t& current_worker()
+  {
+    static thread_local uint32_t id = 0u;
+    return id;
+  }
+
+  static void execute( Task& task )
+  {
+    task.fn();
+    task.done.store( true, std::memory_order_release );
+  }
+
+  /* Take the oldest task of another worker, if any. */
+  Task* steal( uint32_t thief )
+  {
+    for ( auto i = 1u; i < deques.size(); ++i )
+    {
+      Deque& victim = *deques[( thief + i ) % deques.size()];
+      std::lock_guard<std::mutex> lock( victim.mutex );
+      if ( !victim.tasks.empty() )
+      {
+        Task* task = victim.tasks.front();
+        victim.tasks.pop_front();
+        return task;
+      }
+    }
+    return nullptr;
+  }
+
+  void work( uint32_t id )
+  {
+    current_worker() = id;
+    while ( true )
+    {
+      if ( !active.load( std::memory_order_acquire ) )
+      {
+        std::unique_lock<std::mutex> lock( state_mutex );
+        wake_up.wait( lock, [this]() { return active.load( std::memory_order_acquire ) || stop; } );
+        if ( stop )
+        {
+          return;
+        }
+      }
+      if ( Task* task = steal( id ) )
+      {
+        execute( *task );
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+private:
+  std::vector<std::unique_ptr<Deque>> deques;
+  std::vector<std::thread> threads;
+
+  std::mutex state_mutex;
+  std::condition_variable wake_up;
+  std::atomic<bool> active; /* whether `run` is in progress */
+  bool stop; /* whether the pool is being destroyed */
+};